@@ -82,6 +82,12 @@
 # define O_RDWR         _O_RDWR
 #endif
 
+/*  Corked entries are carved out of chunks of this many entries; this many
+ *  chunks are kept after uncorking for reuse by the next input.
+ */
+#define CORK_CHUNK_ENTRIES 256
+#define CORK_CHUNKS_KEPT   4
+
 
 /*  Maintains the state of the tag file.
  */
@@ -96,6 +102,7 @@ typedef struct eTagFile {
 	int cork;
 	unsigned int corkFlags;
 	ptrArray *corkQueue;
+	struct sCorkChunk *corkChunks;	/* storage of corkQueue entries, newest first */
 	struct rb_root intervaltab;
 
 	bool patternCacheValid;
@@ -110,6 +117,12 @@ typedef struct sTagEntryInfoX  {
 	unsigned long __intervalnode_subtree_last;
 } tagEntryInfoX;
 
+typedef struct sCorkChunk {
+	struct sCorkChunk *next;
+	unsigned int used;
+	tagEntryInfoX entries [CORK_CHUNK_ENTRIES];
+} corkChunk;
+
 /*
 *   DATA DEFINITIONS
 */
@@ -123,6 +136,7 @@ static tagFile TagFile = {
 	NULL,                /* vLine */
 	.cork = false,
 	.corkQueue = NULL,
+	.corkChunks = NULL,
 	/* .intervaltab = RB_ROOT,
 	 *
 	 * msvc doesn't accept the above expression:
@@ -135,6 +149,9 @@ static tagFile TagFile = {
 
 static bool TagsToStdout = false;
 
+static corkChunk *SpareCorkChunks = NULL;
+static unsigned int SpareCorkChunkCount = 0;
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -162,6 +179,14 @@ extern void freeTagFileResources (void)
 	if (TagFile.directory != NULL)
 		eFree (TagFile.directory);
 	vStringDelete (TagFile.vLine);
+
+	while (SpareCorkChunks)
+	{
+		corkChunk *next = SpareCorkChunks->next;
+		eFree (SpareCorkChunks);
+		SpareCorkChunks = next;
+	}
+	SpareCorkChunkCount = 0;
 }
 
 extern const char *tagFileName (void)
@@ -751,6 +776,24 @@ static bool isPosSet (MIOPos pos)
 }
 #endif
 
+extern char *takeTagEntryString (tagEntryInfo *const tag, const char **field)
+{
+	char *str = (char *)*field;
+
+	if (str == NULL)
+		return NULL;
+
+	/* A corked entry is deleted right after being written while the queue
+	 * is flushed; only the qualified tag made from it still reads its fields. */
+	if (tag->inCorkQueue && TagFile.cork == 0
+		&& !isXtagEnabled (XTAG_QUALIFIED_TAGS))
+	{
+		*field = NULL;
+		return str;
+	}
+	return eStrdup (str);
+}
+
 extern char *readLineFromBypassForTag (vString *const vLine, const tagEntryInfo *const tag,
 									   long *const pSeekValue)
 {
@@ -1080,9 +1123,50 @@ static void copyParserFields (const tagEntryInfo *const tag, tagEntryInfo* slot)
 
 }
 
+static tagEntryInfoX *allocCorkEntry (void)
+{
+	corkChunk *chunk = TagFile.corkChunks;
+
+	if (chunk == NULL || chunk->used == CORK_CHUNK_ENTRIES)
+	{
+		if (SpareCorkChunks)
+		{
+			chunk = SpareCorkChunks;
+			SpareCorkChunks = chunk->next;
+			SpareCorkChunkCount--;
+		}
+		else
+			chunk = xMalloc (1, corkChunk);
+		chunk->used = 0;
+		chunk->next = TagFile.corkChunks;
+		TagFile.corkChunks = chunk;
+	}
+
+	return chunk->entries + chunk->used++;
+}
+
+static void releaseCorkChunks (void)
+{
+	while (TagFile.corkChunks)
+	{
+		corkChunk *chunk = TagFile.corkChunks;
+		TagFile.corkChunks = chunk->next;
+
+		if (SpareCorkChunkCount < CORK_CHUNKS_KEPT)
+		{
+			chunk->next = SpareCorkChunks;
+			SpareCorkChunks = chunk;
+			SpareCorkChunkCount++;
+		}
+		else
+			eFree (chunk);
+	}
+}
+
 static tagEntryInfo *newNilTagEntry (unsigned int corkFlags)
 {
-	tagEntryInfoX *x = xCalloc (1, tagEntryInfoX);
+	tagEntryInfoX *x = allocCorkEntry ();
+	memset (x, 0, sizeof (*x));
 	x->corkIndex = CORK_NIL;
 	x->symtab = RB_ROOT;
 	x->slot.kindIndex = KIND_FILE_INDEX;
@@ -1110,7 +1194,7 @@ static tagEntryInfoX *copyTagEntry (const tagEntryInfo *const tag,
 									const char *sharedSourceFileName,
 									unsigned int corkFlags)
 {
-	tagEntryInfoX *x = xMalloc (1, tagEntryInfoX);
+	tagEntryInfoX *x = allocCorkEntry ();
 	x->symtab = RB_ROOT;
 	x->corkIndex = CORK_NIL;
 	memset(&x->intervalnode, 0, sizeof (x->intervalnode));
@@ -1211,6 +1295,7 @@ static void clearParserFields (tagEntryInfo *const tag)
 	}
 }
 
+/* Releases what the entry owns, but not the entry: see releaseCorkChunks (). */
 static void deleteTagEnry (void *data)
 {
 	tagEntryInfo *slot = data;
@@ -1220,7 +1305,7 @@ static void deleteTagEnry (void *data)
 		eFree ((char *)slot->inputFileName);
 		if (slot->sourceFileName)
 			eFree ((char *)slot->sourceFileName);
-		goto out;
+		return;
 	}
 
 	if (slot->pattern)
@@ -1257,9 +1342,6 @@ static void deleteTagEnry (void *data)
 		eFree ((char *)slot->sourceFileName);
 
 	clearParserFields (slot);
-
- out:
-	eFree (slot);
 }
 
 static void corkSymtabPut (tagEntryInfoX *scope, const char* name, tagEntryInfoX *item)
@@ -1594,8 +1676,7 @@ static int queueTagEntry (const tagEntryInfo *const tag)
 
 	int corkIndex;
 	tagEntryInfo * nil = ptrArrayItem (TagFile.corkQueue, 0);
-	tagEntryInfoX * entry = copyTagEntry (tag, nil->inputFileName, nil->sourceFileName,
-										TagFile.corkFlags);
+	tagEntryInfoX * entry;
 
 	if (ptrArrayCount (TagFile.corkQueue) == (size_t)INT_MAX)
 	{
@@ -1611,6 +1692,8 @@ static int queueTagEntry (const tagEntryInfo *const tag)
 	}
 	warned = false;
 
+	entry = copyTagEntry (tag, nil->inputFileName, nil->sourceFileName,
+						  TagFile.corkFlags);
 	corkIndex = (int)ptrArrayAdd (TagFile.corkQueue, entry);
 	entry->corkIndex = corkIndex;
 	entry->slot.inCorkQueue = 1;
@@ -1895,6 +1978,7 @@ extern void uncorkTagFile (void)
 
 	ptrArrayDelete (TagFile.corkQueue);
 	TagFile.corkQueue = NULL;
+	releaseCorkChunks ();
 }
 
 extern tagEntryInfo *getEntryInCorkQueue (int n)
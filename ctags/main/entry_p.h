@@ -44,6 +44,12 @@ extern const char* getTagFileDirectory (void);
 extern void getTagScopeInformation (tagEntryInfo *const tag,
 				    const char **kind, const char **name);
 
+/* For writers: returns *FIELD, one of TAG's extensionFields strings, as a
+ * string the caller must eFree. While the cork queue is being flushed, the
+ * entry's own copy is handed over (and *FIELD cleared) instead of being
+ * duplicated. */
+extern char *takeTagEntryString (tagEntryInfo *const tag, const char **field);
+
 /* Getting line associated with tag */
 extern char *readLineFromBypassForTag (vString *const vLine, const tagEntryInfo *const tag,
 				   long *const pSeekValue);
@@ -16,8 +16,12 @@
 */
 #include "general.h"  /* must always come first */
 
+#include <ctype.h>
 #include <regex.h>
+#include <string.h>
 #include "lregex_p.h"
+#include "routines.h"
+#include "vstring.h"
 
 /*
 *    FUNCTION DECLARATIONS
@@ -30,6 +34,8 @@ static regexCompiledCode compile (struct regexBackend *backend,
 								  int flags);
 static void delete_code (void *code);
 static void set_icase_flag (int *flags);
+static void extractLiteral (const char *const regexp, int flags,
+							regexCompiledCode *cc);
 
 /*
 *    DATA DEFINITIONS
@@ -112,7 +118,10 @@ static regexCompiledCode compile (struct regexBackend *backend,
 		eFree (regex_code);
 		return (regexCompiledCode) { .backend = NULL, .code = NULL };
 	}
-	return (regexCompiledCode) { .backend = &defaultRegexBackend, .code = regex_code };
+
+	regexCompiledCode cc = { .backend = &defaultRegexBackend, .code = regex_code };
+	extractLiteral (regexp, flags, &cc);
+	return cc;
 }
 
 static int match (struct regexBackend *backend,
@@ -126,3 +135,177 @@ static void set_icase_flag (int *flags)
 {
 	*flags |= REG_ICASE;
 }
+
+/* Skip a bracket expression starting at P, returning the position
+ * after its closing ']' or NULL if it is not terminated. */
+static const char *skipBracket (const char *p)
+{
+	p++;
+	if (*p == '^')
+		p++;
+	if (*p == ']')
+		p++;
+	while (*p && *p != ']')
+	{
+		if (*p == '[' && (p[1] == ':' || p[1] == '.' || p[1] == '='))
+		{
+			char delim = p[1];
+			p += 2;
+			while (*p && !(*p == delim && p[1] == ']'))
+				p++;
+			if (*p == '\0')
+				return NULL;
+			p += 2;
+		}
+		else
+			p++;
+	}
+	return *p ? p + 1 : NULL;
+}
+
+static void commitLiteralRun (vString *run, bool *runAnchored,
+							  vString *best, bool *bestAnchored)
+{
+	if (vStringLength (run) > 0 && !*bestAnchored
+		&& (*runAnchored || vStringLength (run) > vStringLength (best)))
+	{
+		vStringCopy (best, run);
+		*bestAnchored = *runAnchored;
+	}
+	vStringClear (run);
+	*runAnchored = false;
+}
+
+/* Find a run of characters every match of the extended regular
+ * expression REGEXP must contain, preferring one anchored by a leading
+ * '^'.  Only ASCII characters outside groups are collected, and any
+ * construct not understood here makes us give up, so a literal is only
+ * reported when it is really required.  Case-insensitive patterns are
+ * left alone as their folding depends on the locale. */
+static void extractLiteral (const char *const regexp, int flags,
+							regexCompiledCode *cc)
+{
+	const char *p = regexp;
+	vString *run, *best;
+	bool runAnchored, bestAnchored = false;
+	int depth = 0;
+
+	if (!(flags & REG_EXTENDED) || (flags & REG_ICASE))
+		return;
+
+	run = vStringNew ();
+	best = vStringNew ();
+
+	runAnchored = (*p == '^');
+	if (runAnchored)
+		p++;
+
+	while (*p)
+	{
+		unsigned char c = (unsigned char) *p;
+		int len = 1;
+
+		if (depth > 0)
+		{
+			if (c == '[')
+			{
+				p = skipBracket (p);
+				if (p == NULL)
+					goto giveup;
+				continue;
+			}
+			if (c == '\\' && p[1])
+				p++;
+			else if (c == '(')
+				depth++;
+			else if (c == ')')
+				depth--;
+			p++;
+			continue;
+		}
+
+		switch (c)
+		{
+			case '|':
+			case ')':
+			case '{':
+				goto giveup;
+			case '(':
+				commitLiteralRun (run, &runAnchored, best, &bestAnchored);
+				depth++;
+				p++;
+				continue;
+			case '[':
+				commitLiteralRun (run, &runAnchored, best, &bestAnchored);
+				p = skipBracket (p);
+				if (p == NULL)
+					goto giveup;
+				continue;
+			case '.':
+			case '^':
+			case '$':
+			case '*':
+			case '+':
+			case '?':
+				commitLiteralRun (run, &runAnchored, best, &bestAnchored);
+				p++;
+				continue;
+			case '\\':
+				c = (unsigned char) p[1];
+				if (c == '\0')
+					goto giveup;
+				/* \w, \<, back-references and friends are not literals */
+				if (c >= 0x80 || isalnum (c) || strchr ("<>'`", c))
+				{
+					commitLiteralRun (run, &runAnchored, best, &bestAnchored);
+					p += 2;
+					continue;
+				}
+				len = 2;
+				break;
+			default:
+				/* a quantifier would apply to the whole multibyte character */
+				if (c >= 0x80)
+				{
+					commitLiteralRun (run, &runAnchored, best, &bestAnchored);
+					p++;
+					continue;
+				}
+				break;
+		}
+
+		p += len;
+		if (*p == '*' || *p == '?' || *p == '+' || *p == '{')
+		{
+			/* "c+" still requires one "c", but quantifiers can be
+			 * stacked and "c+?" doesn't */
+			bool optional = false;
+			for (; *p && strchr ("*?+{", *p); p++)
+			{
+				if (*p == '{')
+					goto giveup;
+				optional = optional || *p != '+';
+			}
+			if (!optional)
+				vStringPut (run, c);
+			commitLiteralRun (run, &runAnchored, best, &bestAnchored);
+		}
+		else
+			vStringPut (run, c);
+	}
+	commitLiteralRun (run, &runAnchored, best, &bestAnchored);
+
+	if (vStringLength (best) > 0)
+	{
+		cc->literalLength = vStringLength (best);
+		cc->literalAnchored = bestAnchored;
+		cc->literalAfterNewline = bestAnchored && (flags & REG_NEWLINE);
+		cc->literal = vStringDeleteUnwrap (best);
+		best = NULL;
+	}
+
+giveup:
+	vStringDelete (run);
+	if (best)
+		vStringDelete (best);
+}
@@ -330,6 +330,8 @@ static void deletePattern (regexPattern *p)
 		return;
 
 	p->pattern.backend->delete_code (p->pattern.code);
+	if (p->pattern.literal)
+		eFree (p->pattern.literal);
 
 	if (p->type == PTRN_TAG)
 	{
@@ -716,8 +718,7 @@ static regexPattern * newPattern (regexCompiledCode* const pattern,
 {
 	regexPattern *ptrn = xCalloc(1, regexPattern);
 
-	ptrn->pattern.backend = pattern->backend;
-	ptrn->pattern.code = pattern->code;
+	ptrn->pattern = *pattern;
 
 	ptrn->exclusive = false;
 	ptrn->postrun = false;
@@ -1995,6 +1996,57 @@ static bool fillGuestRequest (const char *start,
 	return guestRequestIsFilled (guest_req);
 }
 
+/* Cheap check done before handing INPUT to the regex backend: if the
+ * pattern is known to require a literal that INPUT doesn't contain, the
+ * pattern cannot match. */
+static bool inputMayMatch (const regexCompiledCode *const code,
+						   const char *input, size_t size)
+{
+	const char *const end = input + size;
+	const char *p = input;
+
+	if (code->literal == NULL)
+		return true;
+
+	if (code->literalAnchored)
+	{
+		while (true)
+		{
+			if ((size_t)(end - p) >= code->literalLength
+				&& memcmp (p, code->literal, code->literalLength) == 0)
+				return true;
+			if (!code->literalAfterNewline)
+				return false;
+			p = memchr (p, '\n', end - p);
+			if (p == NULL)
+				return false;
+			p++;
+		}
+	}
+
+	while ((size_t)(end - p) >= code->literalLength)
+	{
+		p = memchr (p, code->literal[0], end - p - code->literalLength + 1);
+		if (p == NULL)
+			return false;
+		if (memcmp (p, code->literal, code->literalLength) == 0)
+			return true;
+		p++;
+	}
+	return false;
+}
+
+static int matchCompiledCode (regexPattern *patbuf, const char *input, size_t size,
+							  regmatch_t pmatch[BACK_REFERENCE_COUNT])
+{
+	if (!inputMayMatch (&patbuf->pattern, input, size))
+		return REG_NOMATCH;
+
+	return patbuf->pattern.backend->match (patbuf->pattern.backend,
+										   patbuf->pattern.code, input, size,
+										   pmatch);
+}
+
 static bool matchRegexPattern (struct lregexControlBlock *lcb,
 							   const vString* const line,
 							   regexTableEntry *entry)
@@ -2008,10 +2060,8 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
-	match = patbuf->pattern.backend->match (patbuf->pattern.backend,
-											patbuf->pattern.code, vStringValue (line),
-											vStringLength (line),
-											pmatch);
+	match = matchCompiledCode (patbuf, vStringValue (line),
+							   vStringLength (line), pmatch);
 
 	if (match == 0)
 	{
@@ -2095,10 +2145,9 @@ static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
 	current = start = vStringValue (allLines);
 	do
 	{
-		match = patbuf->pattern.backend->match (patbuf->pattern.backend,
-												patbuf->pattern.code, current,
-												vStringLength (allLines) - (current - start),
-												pmatch);
+		match = matchCompiledCode (patbuf, current,
+								   vStringLength (allLines) - (current - start),
+								   pmatch);
 
 		if (match != 0)
 		{
@@ -2959,10 +3008,9 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 		if (ptrn->disabled && *(ptrn->disabled))
 			continue;
 
-		match = ptrn->pattern.backend->match (ptrn->pattern.backend,
-											  ptrn->pattern.code, current,
-											  vStringLength(start) - (current - cstart),
-											  pmatch);
+		match = matchCompiledCode (ptrn, current,
+								   vStringLength(start) - (current - cstart),
+								   pmatch);
 		if (match == 0)
 		{
 			entry->statistics.match++;
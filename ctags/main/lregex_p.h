@@ -47,6 +47,17 @@ struct lregexControlBlock;
 typedef struct sRegexCompiledCode {
 	struct regexBackend *backend;
 	void * code;
+
+	/* A run of plain characters every match must contain, filled by
+	 * backends which can derive one from the pattern.  Inputs that
+	 * don't contain it are rejected without calling match().
+	 * NULL when nothing is known about the pattern. */
+	char *literal;
+	size_t literalLength;
+	/* The literal must appear right at the start of the input... */
+	bool literalAnchored;
+	/* ...or right after a newline (REG_NEWLINE semantics). */
+	bool literalAfterNewline;
 } regexCompiledCode;
 
 struct regexBackend {
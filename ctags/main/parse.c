@@ -4521,6 +4521,11 @@ static bool createTagsWithFallback1 (const langType language,
 		  createTagsForFile (language, ++passCount) )
 		!= RESCAN_NONE)
 	{
+		/* Another pass would only see the input already cut short by
+		 * the input budget, so keep what this pass has found. */
+		if (isInputBudgetExhausted ())
+			break;
+
 		if (useCork)
 		{
 			uncorkTagFile();
@@ -123,6 +123,19 @@ enum areaCoord {
 	AREA_COORD_CURRENT,
 };
 
+typedef struct sInputBudget {
+	size_t maxBytes;        /* 0 means unlimited */
+	inputBudgetExpiredFunc expired;
+	void *data;
+	size_t bytesRead;       /* since openInputFile (), rescans included */
+	unsigned int charsUntilCheck; /* see getcFromInputFile () */
+	bool exhausted;
+	bool timedOut;          /* exhausted because expired () returned true */
+} inputBudget;
+
+/* How often the time budget is checked while a line is consumed */
+#define INPUT_BUDGET_CHECK_CHARS 4096
+
 static inputLangInfo inputLang;
 static langType sourceLang;
 
@@ -144,6 +157,7 @@ static unsigned long getAreaStartLineNumber (void);
 *   DATA DEFINITIONS
 */
 static inputFile File;  /* static read through functions */
+static inputBudget Budget;  /* kept outside File so pushArea () doesn't stash it */
 static inputFile BackupFile;	/* File is copied here when a guest parser is pushed */
 static compoundPos StartOfLine;  /* holds deferred position of start of line */
 
@@ -1011,6 +1025,12 @@ extern bool openInputFile (const char *const fileName, const langType language,
 		allocLineFposMap (&File.lineFposMap);
 
 		File.thinDepth = 0;
+
+		Budget.bytesRead = 0;
+		Budget.charsUntilCheck = INPUT_BUDGET_CHECK_CHARS;
+		Budget.exhausted = false;
+		Budget.timedOut = false;
+
 		verbose ("OPENING%s %s as %s language %sfile [%s%s]\n",
 				 (File.bomFound? "(skipping utf-8 bom)": ""),
 				 fileName,
@@ -1111,7 +1131,8 @@ typedef enum eEolType {
 	eol_cr_nl,
 } eolType;
 
-static eolType readLine (vString *const vLine, MIO *const mio)
+/* maxLength, if not 0, cuts a line longer than that as if the input ended */
+static eolType readLine (vString *const vLine, MIO *const mio, size_t maxLength)
 {
 	char *str;
 	size_t size;
@@ -1153,6 +1174,12 @@ static eolType readLine (vString *const vLine, MIO *const mio)
 		if (newLine || eof)
 			break;
 
+		if (maxLength > 0 && vStringLength (vLine) >= maxLength)
+		{
+			r = eol_eof;
+			break;
+		}
+
 		vStringResize (vLine, vStringLength (vLine) * 2);
 		str = vStringValue (vLine) + vStringLength (vLine);
 		size = vStringSize (vLine) - vStringLength (vLine);
@@ -1160,13 +1187,75 @@ static eolType readLine (vString *const vLine, MIO *const mio)
 	return r;
 }
 
+extern void setInputBudget (size_t maxBytes, inputBudgetExpiredFunc expired, void *data)
+{
+	Budget.maxBytes = maxBytes;
+	Budget.expired = expired;
+	Budget.data = data;
+}
+
+extern bool isInputBudgetExhausted (void)
+{
+	return Budget.exhausted;
+}
+
+static bool isInputBudgetAvailable (void)
+{
+	if (Budget.exhausted)
+		return false;
+
+	if (Budget.maxBytes > 0 && Budget.bytesRead >= Budget.maxBytes)
+		Budget.exhausted = true;
+	else if (Budget.expired && Budget.expired (Budget.data))
+		Budget.exhausted = Budget.timedOut = true;
+
+	if (Budget.exhausted)
+		verbose ("input budget of %s exhausted after %lu bytes%s\n",
+				 getInputFileName (), (unsigned long) Budget.bytesRead,
+				 Budget.timedOut ? " (timed out)" : "");
+
+	return !Budget.exhausted;
+}
+
+static bool isInputTimeAvailable (void)
+{
+	if (Budget.timedOut)
+		return false;
+
+	if (Budget.expired && Budget.expired (Budget.data))
+	{
+		Budget.exhausted = Budget.timedOut = true;
+		verbose ("input budget of %s timed out inside a line\n",
+				 getInputFileName ());
+	}
+	return !Budget.timedOut;
+}
+
 static vString *iFileGetLine (bool chop_newline)
 {
 	eolType eol;
 	langType lang = getInputLanguage();
 
 	Assert (File.line);
-	eol = readLine (File.line, File.mio);
+	if (isInputBudgetAvailable ())
+	{
+		/* a single huge line (minified code) is cut at the byte budget too */
+		eol = readLine (File.line, File.mio,
+						Budget.maxBytes > 0 ? Budget.maxBytes - Budget.bytesRead : 0);
+		Budget.bytesRead += vStringLength (File.line);
+		if (Budget.maxBytes > 0 && eol == eol_eof && !mio_eof (File.mio))
+		{
+			Budget.exhausted = true;
+			verbose ("input budget of %s exhausted inside a line\n",
+					 getInputFileName ());
+		}
+	}
+	else
+	{
+		/* Behave as if the input ended here */
+		vStringClear (File.line);
+		eol = eol_eof;
+	}
 
 	if (vStringLength (File.line) > 0)
 	{
@@ -1193,6 +1282,14 @@ static vString *iFileGetLine (bool chop_newline)
 	}
 	else
 	{
+		/* Skip the whole-input passes if we ran out of time; with only the
+		 * byte limit hit, File.allLines is bounded and still worth matching. */
+		if (File.allLines && Budget.timedOut)
+		{
+			vStringDelete (File.allLines);
+			File.allLines = NULL;
+		}
+
 		if (File.allLines)
 		{
 			matchLanguageMultilineRegex (lang, File.allLines);
@@ -1256,6 +1353,18 @@ extern int getcFromInputFile (void)
 	{
 		if (File.currentLine != NULL)
 		{
+			/* Lines are only checked against the budget before being read,
+			 * so also check the time while a long line is consumed */
+			if (Budget.expired && --Budget.charsUntilCheck == 0)
+			{
+				Budget.charsUntilCheck = INPUT_BUDGET_CHECK_CHARS;
+				if (!isInputTimeAvailable ())
+				{
+					File.currentLine = NULL;
+					c = EOF;
+					break;
+				}
+			}
 			c = *File.currentLine++;
 			if (c == '\0')
 				File.currentLine = NULL;
@@ -1344,7 +1453,7 @@ extern char *readLineRaw (vString *const vLine, MIO *const mio)
 		error (FATAL, "NULL file pointer");
 	else
 	{
-		readLine (vLine, mio);
+		readLine (vLine, mio, 0);
 
 #ifdef HAVE_ICONV
 		if (isConverting ())
@@ -1440,7 +1549,7 @@ extern bool   pushArea (
 	{
 		long line_start = mio_tell (File.mio);
 		vString *tmpstr = vStringNew ();
-		readLine (tmpstr, File.mio);
+		readLine (tmpstr, File.mio, 0);
 		endColumn = mio_tell (File.mio) - line_start;
 		vStringDelete (tmpstr);
 		Assert (endColumn >= 0);
@@ -27,6 +27,10 @@ enum areaBoundaryFlag {
 	AREA_BOUNDARY_END   = 1UL << 1,
 };
 
+/* Called by the read loop before each input line is read. Returning true
+   stops reading the current input file as if EOF were reached. */
+typedef bool (* inputBudgetExpiredFunc) (void *data);
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -59,6 +63,14 @@ extern void resetInputFile (const langType language, bool resetLineFposMap_);
 extern void closeInputFile (void);
 extern void *getInputFileUserData(void);
 
+/* Limits how much of an input file the parsers may read. Once maxBytes
+   bytes (0 means no limit) have been read, or once expired returns true,
+   the rest of the input is hidden from the parsers. The budget is
+   restarted by each openInputFile () and stays in effect until it is
+   replaced; pass 0 and NULL to remove it. */
+extern void setInputBudget (size_t maxBytes, inputBudgetExpiredFunc expired, void *data);
+extern bool isInputBudgetExhausted (void);
+
 
 /* args (line): [absolute] */
 extern unsigned int getAreaBoundaryInfo (unsigned long lineNumber);
@@ -62,7 +62,8 @@ typedef enum { COMMENT_NONE, COMMENT_C, COMMENT_CPLUS, COMMENT_D } Comment;
 
 enum eCppLimits {
 	MaxCppNestingLevel = 20,
-	MaxDirectiveName = 10
+	MaxDirectiveName = 10,
+	MaxMacroDefinitionCaches = 16
 };
 
 /* For tracking __ASSEMBLER__ area. */
@@ -104,6 +105,23 @@ enum eState {
 	DRCTV_INCLUDE, /* "#include" encountered */
 };
 
+/*  Macro definitions parsed from the tags of one input file. They are
+ *  kept across parses of the same input so that reparsing an edited
+ *  buffer doesn't parse every definition again. Entries are keyed by the
+ *  whole definition text ("name(params)=value"), so a changed #define
+ *  just misses; entries not used during a parse are dropped at its end.
+ */
+typedef struct sMacroDefinitionCache {
+	char *inputFileName;
+	hashTable *definitions;  /* definition text -> cachedMacroDefinition */
+	unsigned int generation; /* incremented for every parse of the input */
+} macroDefinitionCache;
+
+typedef struct sCachedMacroDefinition {
+	cppMacroInfo *info;
+	unsigned int generation; /* of the last parse which used the macro */
+} cachedMacroDefinition;
+
 /*  Defines the current state of the pre-processor.
  */
 typedef struct sUngetBuffer {
@@ -160,7 +178,9 @@ typedef struct sCppState {
 	} directive;
 
 	cppMacroInfo * macroInUse;
-	hashTable * fileMacroTable;
+	hashTable * fileMacroTable;         /* macros are owned by macroCache */
+	macroDefinitionCache * macroCache;
+	size_t macroExpansionBytes;         /* produced by cppExpandMacro() so far */
 
 } cppState;
 
@@ -240,6 +260,11 @@ static fieldDefinition CPreProFields[COUNT_FIELD] = {
 static bool doesExaminCodeWithInIf0Branch;
 static bool doesExpandMacros;
 
+/*  Definition caches of the most recently parsed inputs, least recently
+ *  used first.
+ */
+static ptrArray *macroDefinitionCaches;
+
 /*
 * CXX parser state. This is stored at the beginning of a conditional.
 * If at the exit of the conditional the state is changed then we assume
@@ -305,7 +330,14 @@ static cppState Cpp = {
 */
 
 static hashTable *makeMacroTable (void);
+static hashTable *makeMacroRefTable (void);
 static cppMacroInfo * saveMacro(hashTable *table, const char * macro);
+static cppMacroInfo * parseMacro(const char * macro);
+static void freeMacroInfo(cppMacroInfo * info);
+static macroDefinitionCache * getMacroDefinitionCache (const char *inputFileName);
+static void sweepMacroDefinitionCache (macroDefinitionCache *cache);
+static cppMacroInfo * cacheMacro (macroDefinitionCache *cache, hashTable *table,
+								  const char *macro);
 
 static void cppMacroTokensDelete (cppMacroTokens *tokens);
 
@@ -445,6 +477,7 @@ static void cppInitCommon(langType clientLang,
 	Cpp.directive.name = vStringNewOrClear (Cpp.directive.name);
 
 	Cpp.macroInUse = NULL;
+	Cpp.macroExpansionBytes = 0;
 	Cpp.fileMacroTable =
 		(doesExpandMacros
 		 && isFieldEnabled (FIELD_SIGNATURE)
@@ -452,7 +485,10 @@ static void cppInitCommon(langType clientLang,
 		 && (getLanguageCorkUsage ((clientLang == LANG_IGNORE)
 								   ? Cpp.lang
 								   : clientLang) & CORK_SYMTAB))
-		? makeMacroTable ()
+		? makeMacroRefTable ()
+		: NULL;
+	Cpp.macroCache = Cpp.fileMacroTable
+		? getMacroDefinitionCache (getInputFileName ())
 		: NULL;
 }
 
@@ -515,6 +551,12 @@ extern void cppTerminate (void)
 		hashTableDelete (Cpp.fileMacroTable);
 		Cpp.fileMacroTable = NULL;
 	}
+
+	if (Cpp.macroCache)
+	{
+		sweepMacroDefinitionCache (Cpp.macroCache);
+		Cpp.macroCache = NULL;
+	}
 }
 
 extern void cppBeginStatement (void)
@@ -702,7 +744,9 @@ extern void cppUngetString(const char * string, int len)
 
 extern void cppUngetMacroTokens (cppMacroTokens *tokens)
 {
-	Assert (tokens);
+	/* cppExpandMacro() refused to expand */
+	if (!tokens)
+		return;
 
 	cppMacroInfo *macro = tokens->macro;
 
@@ -2202,7 +2246,7 @@ static bool buildMacroInfoFromTagEntry (int corkIndex,
 		if (val)
 			vStringCatS (macrodef, val);
 
-		*info = saveMacro (Cpp.fileMacroTable, vStringValue (macrodef));
+		*info = cacheMacro (Cpp.macroCache, Cpp.fileMacroTable, vStringValue (macrodef));
 		vStringDelete (macrodef);
 
 		return false;
@@ -2210,6 +2254,113 @@ static bool buildMacroInfoFromTagEntry (int corkIndex,
 	return true;
 }
 
+static void cachedMacroDefinitionDelete (cachedMacroDefinition *d)
+{
+	freeMacroInfo (d->info);
+	eFree (d);
+}
+
+static void macroDefinitionCacheDelete (macroDefinitionCache *cache)
+{
+	hashTableDelete (cache->definitions);
+	eFree (cache->inputFileName);
+	eFree (cache);
+}
+
+static macroDefinitionCache * getMacroDefinitionCache (const char *inputFileName)
+{
+	macroDefinitionCache *cache = NULL;
+
+	if (!inputFileName)
+		inputFileName = "";
+
+	if (!macroDefinitionCaches)
+		macroDefinitionCaches = ptrArrayNew ((ptrArrayDeleteFunc)macroDefinitionCacheDelete);
+
+	for (unsigned int i = 0; i < ptrArrayCount (macroDefinitionCaches); i++)
+	{
+		macroDefinitionCache *c = ptrArrayItem (macroDefinitionCaches, i);
+		if (strcmp (c->inputFileName, inputFileName) == 0)
+		{
+			cache = ptrArrayRemoveItem (macroDefinitionCaches, i);
+			break;
+		}
+	}
+
+	if (!cache)
+	{
+		if (ptrArrayCount (macroDefinitionCaches) >= MaxMacroDefinitionCaches)
+			ptrArrayDeleteItem (macroDefinitionCaches, 0);
+
+		cache = xMalloc (1, macroDefinitionCache);
+		cache->inputFileName = eStrdup (inputFileName);
+		cache->definitions = hashTableNew (1024, hashCstrhash, hashCstreq, eFree,
+										   (hashTableDeleteFunc)cachedMacroDefinitionDelete);
+		cache->generation = 0;
+	}
+
+	/* most recently used last */
+	ptrArrayAdd (macroDefinitionCaches, cache);
+	cache->generation++;
+
+	return cache;
+}
+
+struct staleMacroDefinitions {
+	unsigned int generation;
+	ptrArray *keys;
+};
+
+static bool collectStaleMacroDefinition (const void *key, void *value, void *user_data)
+{
+	cachedMacroDefinition *d = value;
+	struct staleMacroDefinitions *stale = user_data;
+
+	if (d->generation != stale->generation)
+		ptrArrayAdd (stale->keys, (void *)key);
+	return true;
+}
+
+/* Drop the definitions which were not used by the parse which just ended:
+ * they were removed or changed in the input. */
+static void sweepMacroDefinitionCache (macroDefinitionCache *cache)
+{
+	struct staleMacroDefinitions stale = {
+		.generation = cache->generation,
+		.keys = ptrArrayNew (NULL),
+	};
+
+	hashTableForeachItem (cache->definitions, collectStaleMacroDefinition, &stale);
+	for (unsigned int i = 0; i < ptrArrayCount (stale.keys); i++)
+		hashTableDeleteItem (cache->definitions, ptrArrayItem (stale.keys, i));
+
+	ptrArrayDelete (stale.keys);
+}
+
+/* Like saveMacro() but reuses the cppMacroInfo parsed from the same
+ * definition during a previous parse of the input. */
+static cppMacroInfo * cacheMacro (macroDefinitionCache *cache, hashTable *table,
+								  const char *macro)
+{
+	cachedMacroDefinition *d = hashTableGetItem (cache->definitions, macro);
+
+	if (!d)
+	{
+		cppMacroInfo *info = parseMacro (macro);
+		if (!info)
+			return NULL;
+
+		d = xMalloc (1, cachedMacroDefinition);
+		d->info = info;
+		hashTablePutItem (cache->definitions, eStrdup (macro), d);
+	}
+
+	d->generation = cache->generation;
+	hashTablePutItem (table, d->info->name, d->info);
+
+	return d->info;
+}
+
 static cppMacroInfo * cppFindMacroFromSymtab (const char *const name)
 {
 	cppMacroInfo *info = NULL;
@@ -2317,6 +2468,13 @@ extern cppMacroTokens *cppExpandMacro (cppMacroInfo * macro,
 		return NULL;
 	}
 
+	if(Cpp.macroExpansionBytes >= CPP_MAXIMUM_MACRO_EXPANSION_BYTES_PER_INPUT)
+	{
+		CXX_DEBUG_PRINT ("Macro expansion budget exhausted when processing \"%s\": %zu",
+						 macro->name, Cpp.macroExpansionBytes);
+		return NULL;
+	}
+
 	if(!macro->replacements)
 		return NULL;
 
@@ -2383,6 +2541,12 @@ extern cppMacroTokens *cppExpandMacro (cppMacroInfo * macro,
 	if (t->str == NULL)
 		t->str = vStringDeleteUnwrap (vstr);
 
+	for (size_t i = 0; i < ptrArrayCount (tokens->tarray); i++)
+	{
+		t = ptrArrayItem (tokens->tarray, i);
+		Cpp.macroExpansionBytes += strlen (t->str);
+	}
+
 	return tokens;
 }
 
@@ -2488,13 +2652,22 @@ static void saveIgnoreToken(const char * ignoreToken)
 
 static cppMacroInfo * saveMacro(hashTable *table, const char * macro)
 {
-	CXX_DEBUG_ENTER_TEXT("Save macro %s",macro);
+	Assert (table);
+
+	cppMacroInfo * info = parseMacro(macro);
+	if(info)
+		hashTablePutItem(table,info->name,info);
+
+	return info;
+}
+
+static cppMacroInfo * parseMacro(const char * macro)
+{
+	CXX_DEBUG_ENTER_TEXT("Parse macro %s",macro);
 
 	if(!macro)
 		return NULL;
 
-	Assert (table);
-
 	const char * c = macro;
 
 	// skip initial spaces
@@ -2790,7 +2963,6 @@ static cppMacroInfo * saveMacro(hashTable *table, const char * macro)
 	}
 
 	info->name = eStrndup(identifierBegin,identifierEnd - identifierBegin);
-	hashTablePutItem(table,info->name,info);
 	CXX_DEBUG_LEAVE();
 
 	return info;
@@ -2824,6 +2996,18 @@ static hashTable *makeMacroTable (void)
 		);
 }
 
+/* A table of macros owned by somebody else. */
+static hashTable *makeMacroRefTable (void)
+{
+	return hashTableNew(
+		1024,
+		hashCstrhash,
+		hashCstreq,
+		NULL,
+		NULL
+		);
+}
+
 static void initializeCpp (const langType language)
 {
 	Cpp.lang = language;
@@ -2836,6 +3020,12 @@ static void finalizeCpp (const langType language, bool initialized)
 		hashTableDelete (cmdlineMacroTable);
 		cmdlineMacroTable = NULL;
 	}
+
+	if (macroDefinitionCaches)
+	{
+		ptrArrayDelete (macroDefinitionCaches);
+		macroDefinitionCaches = NULL;
+	}
 }
 
 static bool CpreProExpandMacrosInInput (const langType language CTAGS_ATTR_UNUSED, const char *name, const char *arg)
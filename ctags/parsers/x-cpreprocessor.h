@@ -132,6 +132,12 @@ extern void cppPopExternalParserBlock(void);
    times in a recursive macro expansion. */
 #define CPP_MAXIMUM_MACRO_USE_COUNT 8
 
+/* We stop applying macro replacements once all the expansions done in
+   an input file have produced this many bytes. Protects from inputs where
+   every single expansion stays within the limits above but their number
+   explodes. */
+#define CPP_MAXIMUM_MACRO_EXPANSION_BYTES_PER_INPUT (16 * 1024 * 1024)
+
 typedef struct sCppMacroReplacementPartInfo cppMacroReplacementPartInfo;
 
 typedef struct sCppMacroInfo {
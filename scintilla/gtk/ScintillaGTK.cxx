@@ -700,7 +700,7 @@ void ScintillaGTK::Init() {
 		caret.period = 0;
 	}
 
-	for (size_t tr = static_cast<size_t>(TickReason::caret); tr <= static_cast<size_t>(TickReason::dwell); tr++) {
+	for (size_t tr = static_cast<size_t>(TickReason::caret); tr <= static_cast<size_t>(TickReason::wrap); tr++) {
 		timers[tr].reason = static_cast<TickReason>(tr);
 		timers[tr].scintilla = this;
 	}
@@ -714,7 +714,7 @@ void ScintillaGTK::Init() {
 }
 
 void ScintillaGTK::Finalise() {
-	for (size_t tr = static_cast<size_t>(TickReason::caret); tr <= static_cast<size_t>(TickReason::dwell); tr++) {
+	for (size_t tr = static_cast<size_t>(TickReason::caret); tr <= static_cast<size_t>(TickReason::wrap); tr++) {
 		FineTickerCancel(static_cast<TickReason>(tr));
 	}
 	if (accessible) {
@@ -3357,6 +3357,105 @@ void scintilla_release_resources(void) {
 	}
 }
 
+/* Lexes big ranges of the current document in chunks on up to threads threads, with
+ * lexers created by create_lexer. Only suitable for lexers that keep all their state
+ * in the document styles and line states. */
+void scintilla_set_parallel_lexing(ScintillaObject *sci, guint threads, void *(*create_lexer)(const char *name)) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	try {
+		psci->SetParallelLexing(threads, create_lexer);
+	} catch (...) {
+	}
+}
+
+/* Limits the memory used by the undo history of the current document to about limit
+ * bytes, spilling older undo text to a temporary file. 0 for no limit. */
+GEANY_EXPORT_SYMBOL
+void scintilla_set_undo_memory_limit(ScintillaObject *sci, gsize limit) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	psci->pdoc->SetUndoMemoryLimit(limit);
+}
+
+/* Lines of at least length bytes are, when not wrapped, only measured around the
+ * horizontally visible part, with estimated positions elsewhere. 0 to measure all lines. */
+void scintilla_set_long_line_layout_length(ScintillaObject *sci, gintptr length) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	try {
+		psci->SetLongLineLayoutLength(length);
+	} catch (...) {
+	}
+}
+
+/* Wraps the lines after the visible ones on layout threads instead of in idle time, only
+ * setting their heights in idle time. */
+GEANY_EXPORT_SYMBOL
+void scintilla_set_background_wrap(ScintillaObject *sci, gboolean background) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	try {
+		psci->SetBackgroundWrap(background);
+	} catch (...) {
+	}
+}
+
+/* Like SCI_INDICATORFILLRANGE with the current indicator and value for n_ranges
+ * (start, end) pairs sorted by start, but rebuilding the indicator in one pass. */
+GEANY_EXPORT_SYMBOL
+void scintilla_indicator_fill_ranges(ScintillaObject *sci, const gintptr *ranges, gsize n_ranges) {
+	static_assert(sizeof(gintptr) == sizeof(Sci::Position));
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	try {
+		psci->pdoc->DecorationFillRanges(reinterpret_cast<const Sci::Position *>(ranges), n_ranges,
+			psci->pdoc->decorations->GetCurrentValue());
+	} catch (...) {
+	}
+}
+
+/* Whether the current document holds style bytes, which only happens once a style other
+ * than 0 is set. */
+GEANY_EXPORT_SYMBOL
+gboolean scintilla_get_styles_allocated(ScintillaObject *sci) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	return psci->pdoc->StylesAllocated();
+}
+
+/* C access to the ILoader interface, so that a document can be filled from a
+ * background thread without going through a widget. This matches what
+ * SCI_CREATELOADER does, minus resetting the calling view's contraction state. */
+void *scintilla_loader_new(gintptr bytes, int options) {
+	try {
+		Document *doc = new Document(static_cast<DocumentOption>(options));
+		doc->AddRef();
+		doc->Allocate(bytes);
+		doc->SetUndoCollection(false);
+		return static_cast<ILoader *>(doc);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+int scintilla_loader_add_data(void *loader, const char *data, gintptr length) {
+	return static_cast<ILoader *>(loader)->AddData(data, length);
+}
+
+/* Sizes the line index for the expected number of lines before adding data. This is
+ * only a hint, so running out of memory here is left to AddData to report. */
+void scintilla_loader_allocate_lines(void *loader, gintptr lines) {
+	try {
+		static_cast<Document *>(static_cast<ILoader *>(loader))->AllocateLines(lines);
+	} catch (...) {
+	}
+}
+
+/* The returned pointer is suitable for SCI_SETDOCPOINTER and must be released
+ * with SCI_RELEASEDOCUMENT. The loader must not be used afterwards. */
+void *scintilla_loader_convert_to_document(void *loader) {
+	return static_cast<ILoader *>(loader)->ConvertToDocument();
+}
+
+void scintilla_loader_release(void *loader) {
+	static_cast<ILoader *>(loader)->Release();
+}
+
 /* Define a dummy boxed type because g-ir-scanner is unable to
  * recognize gpointer-derived types. Note that SCNotificaiton
  * is always allocated on stack so copying is not appropriate. */
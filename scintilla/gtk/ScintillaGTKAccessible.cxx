@@ -166,12 +166,20 @@ ScintillaGTKAccessible *ScintillaGTKAccessible::FromAccessible(GtkAccessible *ac
 ScintillaGTKAccessible::ScintillaGTKAccessible(GtkAccessible *accessible_, GtkWidget *widget_) :
 		accessible(accessible_),
 		sci(ScintillaGTK::FromWidget(widget_)),
-		old_pos(-1) {
+		old_pos(-1),
+		changePending(false),
+		changeStart(0),
+		changeTail(0),
+		changeOldLength(0),
+		changeIdleID(0) {
 	SetAccessibility(true);
 	g_signal_connect(widget_, "sci-notify", G_CALLBACK(SciNotify), this);
 }
 
 ScintillaGTKAccessible::~ScintillaGTKAccessible() {
+	if (changeIdleID) {
+		g_source_remove(changeIdleID);
+	}
 	if (gtk_accessible_get_widget(accessible)) {
 		g_signal_handlers_disconnect_matched(sci->sci, G_SIGNAL_MATCH_DATA, 0, 0, nullptr, nullptr, this);
 	}
@@ -436,7 +444,7 @@ gunichar ScintillaGTKAccessible::GetCharacterAtOffset(int charOffset) {
 }
 
 gint ScintillaGTKAccessible::GetCharacterCount() {
-	return sci->pdoc->CountCharacters(0, sci->pdoc->Length());
+	return CharacterCount(sci->pdoc);
 }
 
 gint ScintillaGTKAccessible::GetCaretOffset() {
@@ -842,14 +850,18 @@ void ScintillaGTKAccessible::ChangeDocument(Document *oldDoc, Document *newDoc)
 	}
 
 	if (oldDoc) {
-		int charLength = oldDoc->CountCharacters(0, oldDoc->Length());
+		// changes not reported yet are part of the whole text going away
+		int charLength = changePending ? changeOldLength : CharacterCount(oldDoc);
+		changePending = false;
 		g_signal_emit_by_name(accessible, "text-changed::delete", 0, charLength);
+		oldDoc->ReleaseLineCharacterIndex(LineCharacterIndexType::Utf32);
 	}
 
 	if (newDoc) {
 		PLATFORM_ASSERT(newDoc == sci->pdoc);
 
-		int charLength = newDoc->CountCharacters(0, newDoc->Length());
+		newDoc->AllocateLineCharacterIndex(LineCharacterIndexType::Utf32);
+		int charLength = CharacterCount(newDoc);
 		g_signal_emit_by_name(accessible, "text-changed::insert", 0, charLength);
 
 		if ((oldDoc ? oldDoc->IsReadOnly() : false) != newDoc->IsReadOnly()) {
@@ -879,23 +891,104 @@ void ScintillaGTKAccessible::SetAccessibility(bool enabled) {
 		sci->pdoc->ReleaseLineCharacterIndex(LineCharacterIndexType::Utf32);
 }
 
+// Whether a modification is one of several making up a user action or an undo or
+// redo step, so that it is better reported together with the others
+bool ScintillaGTKAccessible::CoalesceChange(const NotificationData *nt) const {
+	// the pending change is tracked with the character index to keep it cheap
+	if (!FlagSet(sci->pdoc->LineCharacterIndex(), LineCharacterIndexType::Utf32)) {
+		return false;
+	}
+	if (FlagSet(nt->modificationType, ModificationFlags::MultiStepUndoRedo)) {
+		return true;
+	}
+	return sci->pdoc->UndoSequenceDepth() > 0;
+}
+
+// Merges the change of characters [startChar, endChar) of a text lengthBefore
+// characters long into the pending change
+void ScintillaGTKAccessible::AddPendingChange(Sci::Position startChar, Sci::Position endChar, Sci::Position lengthBefore) {
+	if (!changePending) {
+		changePending = true;
+		changeStart = startChar;
+		changeTail = lengthBefore - endChar;
+		changeOldLength = lengthBefore;
+	} else {
+		changeStart = std::min(changeStart, startChar);
+		changeTail = std::min(changeTail, lengthBefore - endChar);
+	}
+	if (!changeIdleID) {
+		changeIdleID = g_idle_add(FlushChangesIdle, this);
+	}
+}
+
+void ScintillaGTKAccessible::FlushChanges(Sci::Position lengthNotReported) {
+	if (changeIdleID) {
+		g_source_remove(changeIdleID);
+		changeIdleID = 0;
+	}
+	if (!changePending) {
+		return;
+	}
+	changePending = false;
+	const Sci::Position lengthNow = CharacterCount(sci->pdoc) - lengthNotReported;
+	const int deleted = changeOldLength - changeTail - changeStart;
+	const int inserted = lengthNow - changeTail - changeStart;
+	if (deleted > 0) {
+		g_signal_emit_by_name(accessible, "text-changed::delete", static_cast<int>(changeStart), deleted);
+	}
+	if (inserted > 0) {
+		g_signal_emit_by_name(accessible, "text-changed::insert", static_cast<int>(changeStart), inserted);
+	}
+	if (lengthNotReported == 0) {
+		UpdateCursor();
+	}
+}
+
+gboolean ScintillaGTKAccessible::FlushChangesIdle(gpointer data) {
+	ScintillaGTKAccessible *scia = static_cast<ScintillaGTKAccessible *>(data);
+	scia->changeIdleID = 0;
+	try {
+		scia->FlushChanges();
+	} catch (...) {}
+	return FALSE;
+}
+
 void ScintillaGTKAccessible::Notify(GtkWidget *, gint, NotificationData *nt) {
 	if (!Enabled())
 		return;
 	switch (nt->nmhdr.code) {
 		case Notification::Modified: {
-			if (FlagSet(nt->modificationType, ModificationFlags::InsertText)) {
-				int startChar = CharacterOffsetFromByteOffset(nt->position);
-				int lengthChar = sci->pdoc->CountCharacters(nt->position, nt->position + nt->length);
-				g_signal_emit_by_name(accessible, "text-changed::insert", startChar, lengthChar);
-				UpdateCursor();
-			}
-			if (FlagSet(nt->modificationType, ModificationFlags::BeforeDelete)) {
+			if (FlagSet(nt->modificationType, ModificationFlags::InsertText | ModificationFlags::BeforeDelete)) {
+				const bool inserted = FlagSet(nt->modificationType, ModificationFlags::InsertText);
+				const bool coalesce = CoalesceChange(nt);
 				int startChar = CharacterOffsetFromByteOffset(nt->position);
-				int lengthChar = sci->pdoc->CountCharacters(nt->position, nt->position + nt->length);
-				g_signal_emit_by_name(accessible, "text-changed::delete", startChar, lengthChar);
+				int lengthChar = CharacterLengthFromByteRange(nt->position, nt->position + nt->length, startChar);
+				if (!coalesce) {
+					// report earlier changes first, without the text just inserted
+					FlushChanges(inserted ? lengthChar : 0);
+				}
+				if (inserted) {
+					if (coalesce) {
+						AddPendingChange(startChar, startChar, CharacterCount(sci->pdoc) - lengthChar);
+					} else {
+						g_signal_emit_by_name(accessible, "text-changed::insert", startChar, lengthChar);
+						UpdateCursor();
+					}
+				} else {
+					if (coalesce) {
+						AddPendingChange(startChar, startChar + lengthChar, CharacterCount(sci->pdoc));
+					} else {
+						g_signal_emit_by_name(accessible, "text-changed::delete", startChar, lengthChar);
+					}
+				}
 			}
-			if (FlagSet(nt->modificationType, ModificationFlags::DeleteText)) {
+			if (changePending) {
+				// report an undo or redo once its last step is done
+				if (FlagSet(nt->modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText) &&
+					FlagSet(nt->modificationType, ModificationFlags::LastStepInUndoRedo)) {
+					FlushChanges();
+				}
+			} else if (FlagSet(nt->modificationType, ModificationFlags::DeleteText)) {
 				UpdateCursor();
 			}
 			if (FlagSet(nt->modificationType, ModificationFlags::ChangeStyle)) {
@@ -903,7 +996,9 @@ void ScintillaGTKAccessible::Notify(GtkWidget *, gint, NotificationData *nt) {
 			}
 		} break;
 		case Notification::UpdateUI: {
-			if (FlagSet(nt->updated, Update::Selection)) {
+			if (changePending) {
+				FlushChanges();
+			} else if (FlagSet(nt->updated, Update::Selection)) {
 				UpdateCursor();
 			}
 		} break;
@@ -22,8 +22,20 @@ private:
 	Sci::Position old_pos;
 	std::vector<SelectionRange> old_sels;
 
+	// text changes inside a user action or undo group, reported as a single change
+	// replacing characters [changeStart, changeOldLength - changeTail)
+	bool changePending;
+	Sci::Position changeStart;
+	Sci::Position changeTail;
+	Sci::Position changeOldLength;
+	guint changeIdleID;
+
 	bool Enabled() const;
 	void UpdateCursor();
+	bool CoalesceChange(const Scintilla::NotificationData *nt) const;
+	void AddPendingChange(Sci::Position startChar, Sci::Position endChar, Sci::Position lengthBefore);
+	void FlushChanges(Sci::Position lengthNotReported=0);
+	static gboolean FlushChangesIdle(gpointer data);
 	void Notify(GtkWidget *widget, gint code, Scintilla::NotificationData *nt);
 	static void SciNotify(GtkWidget *widget, gint code, Scintilla::NotificationData *nt, gpointer data) {
 		try {
@@ -70,9 +82,29 @@ private:
 		return sci->pdoc->IndexLineStart(line, Scintilla::LineCharacterIndexType::Utf32) + sci->pdoc->CountCharacters(lineStart, byteOffset);
 	}
 
+	// Number of characters from startByte, at startChar, to endByte, using the
+	// character index for whole lines rather than counting each character
+	Sci::Position CharacterLengthFromByteRange(Sci::Position startByte, Sci::Position endByte, Sci::Position startChar) {
+		if (FlagSet(sci->pdoc->LineCharacterIndex(), Scintilla::LineCharacterIndexType::Utf32)) {
+			const Sci::Line lineEnd = sci->pdoc->LineFromPosition(endByte);
+			if (lineEnd != sci->pdoc->LineFromPosition(startByte)) {
+				return sci->pdoc->IndexLineStart(lineEnd, Scintilla::LineCharacterIndexType::Utf32) +
+					sci->pdoc->CountCharacters(sci->pdoc->LineStart(lineEnd), endByte) - startChar;
+			}
+		}
+		return sci->pdoc->CountCharacters(startByte, endByte);
+	}
+
+	static Sci::Position CharacterCount(const Document *doc) {
+		if (FlagSet(doc->LineCharacterIndex(), Scintilla::LineCharacterIndexType::Utf32)) {
+			return doc->IndexLineStart(doc->LinesTotal(), Scintilla::LineCharacterIndexType::Utf32);
+		}
+		return doc->CountCharacters(0, doc->Length());
+	}
+
 	void CharacterRangeFromByteRange(Sci::Position startByte, Sci::Position endByte, int *startChar, int *endChar) {
 		*startChar = CharacterOffsetFromByteOffset(startByte);
-		*endChar = *startChar + sci->pdoc->CountCharacters(startByte, endByte);
+		*endChar = *startChar + CharacterLengthFromByteRange(startByte, endByte, *startChar);
 	}
 
 	void ByteRangeFromCharacterRange(int startChar, int endChar, Sci::Position& startByte, Sci::Position& endByte) {
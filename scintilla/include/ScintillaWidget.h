@@ -59,6 +59,18 @@ GtkWidget*	scintilla_new		(void);
 void		scintilla_set_id	(ScintillaObject *sci, uptr_t id);
 sptr_t		scintilla_send_message	(ScintillaObject *sci,unsigned int iMessage, uptr_t wParam, sptr_t lParam);
 void		scintilla_release_resources(void);
+void		scintilla_set_parallel_lexing	(ScintillaObject *sci, guint threads, void *(*create_lexer)(const char *name));
+void		scintilla_set_undo_memory_limit	(ScintillaObject *sci, gsize limit);
+void		scintilla_set_long_line_layout_length	(ScintillaObject *sci, gintptr length);
+void		scintilla_indicator_fill_ranges	(ScintillaObject *sci, const gintptr *ranges, gsize n_ranges);
+void		scintilla_set_background_wrap	(ScintillaObject *sci, gboolean background);
+gboolean	scintilla_get_styles_allocated	(ScintillaObject *sci);
+
+void*		scintilla_loader_new	(gintptr bytes, int options);
+int		scintilla_loader_add_data	(void *loader, const char *data, gintptr length);
+void		scintilla_loader_allocate_lines	(void *loader, gintptr lines);
+void*		scintilla_loader_convert_to_document	(void *loader);
+void		scintilla_loader_release	(void *loader);
 #endif
 
 #define SCINTILLA_NOTIFY "sci-notify"
@@ -16,8 +16,9 @@
 #include <string_view>
 #include <vector>
 #include <map>
-#include <set>
 #include <functional>
+#include <algorithm>
+#include <iterator>
 
 #include "ILexer.h"
 #include "Scintilla.h"
@@ -254,20 +255,27 @@ constexpr bool isCommentASPState(int state) noexcept {
 	return bResult;
 }
 
-bool classifyAttribHTML(script_mode inScriptType, Sci_PositionU start, Sci_PositionU end, const WordList &keywords, const WordClassifier &classifier, Accessor &styler, const std::string &tag) {
+// tagAttribute is a buffer reused between calls, so attributes are classified without allocating.
+bool classifyAttribHTML(script_mode inScriptType, Sci_PositionU start, Sci_PositionU end, const WordList &keywords, const WordClassifier &classifier, Accessor &styler, const std::string &tag, std::string &tagAttribute) {
 	int chAttr = SCE_H_ATTRIBUTEUNKNOWN;
 	bool isLanguageType = false;
 	if (IsNumberChar(styler[start])) {
 		chAttr = SCE_H_NUMBER;
 	} else {
-		const std::string s = styler.GetRangeLowered(start, end+1);
+		// The lowered attribute follows "tag." so tag.attribute needs no other string
+		tagAttribute.assign(tag);
+		tagAttribute.push_back('.');
+		const size_t attributeStart = tagAttribute.length();
+		for (Sci_PositionU cPos = start; cPos <= end; cPos++) {
+			tagAttribute.push_back(MakeLowerCase(styler[cPos]));
+		}
+		const std::string_view s = std::string_view(tagAttribute).substr(attributeStart);
 		if (keywords.InList(s)) {
 			chAttr = SCE_H_ATTRIBUTE;
 		} else {
 			int subStyle = classifier.ValueFor(s);
 			if (subStyle < 0) {
 				// Didn't find attribute, check for tag.attribute
-				const std::string tagAttribute = tag + "." + s;
 				subStyle = classifier.ValueFor(tagAttribute);
 			}
 			if (subStyle >= 0) {
@@ -302,10 +310,37 @@ bool isHTMLCustomElement(const std::string &tag) noexcept {
 	return true;
 }
 
+// Sorted for binary search
+constexpr std::string_view tagsThatDoNotFold[] = {
+	"area",
+	"base",
+	"basefont",
+	"br",
+	"col",
+	"command",
+	"embed",
+	"frame",
+	"hr",
+	"img",
+	"input",
+	"isindex",
+	"keygen",
+	"link",
+	"meta",
+	"param",
+	"source",
+	"track",
+	"wbr"
+};
+
+bool isTagThatDoesNotFold(std::string_view tag) noexcept {
+	return std::binary_search(std::begin(tagsThatDoNotFold), std::end(tagsThatDoNotFold), tag);
+}
+
+// tag keeps its capacity between calls, so tags are classified without allocating.
 int classifyTagHTML(Sci_PositionU start, Sci_PositionU end,
                     const WordList &keywords, const WordClassifier &classifier, Accessor &styler, bool &tagDontFold,
                     bool caseSensitive, bool isXml, bool allowScripts,
-                    const std::set<std::string> &nonFoldingTags,
                     std::string &tag) {
 	tag.clear();
 	// Copy after the '<' and stop before ' '
@@ -321,7 +356,7 @@ int classifyTagHTML(Sci_PositionU start, Sci_PositionU end,
 	// if the current language is XML, I can fold any tag
 	// if the current language is HTML, I don't want to fold certain tags (input, meta, etc.)
 	//...to find it in the list of no-container-tags
-	tagDontFold = (!isXml) && (nonFoldingTags.count(tag) > 0);
+	tagDontFold = (!isXml) && isTagThatDoesNotFold(tag);
 	// No keywords -> all are known
 	int chAttr = SCE_H_TAGUNKNOWN;
 	if (!tag.empty() && (tag[0] == '!')) {
@@ -672,6 +707,9 @@ constexpr bool StyleNeedsBacktrack(int state) noexcept {
 	return InTagState(state) || isPHPStringState(state);
 }
 
+// Lines between the checkpoints saved inside tags and PHP strings
+constexpr Sci_Position checkpointInterval = 32;
+
 enum class AllowPHP : int {
 	None, // No PHP
 	PHP, // <?php and <?=
@@ -1021,28 +1059,6 @@ const LexicalClass lexicalClassesXML[] = {
 	31, "SCE_H_SGML_BLOCK_DEFAULT", "default", "SGML block",
 };
 
-const char * const tagsThatDoNotFold[] = {
-	"area",
-	"base",
-	"basefont",
-	"br",
-	"col",
-	"command",
-	"embed",
-	"frame",
-	"hr",
-	"img",
-	"input",
-	"isindex",
-	"keygen",
-	"link",
-	"meta",
-	"param",
-	"source",
-	"track",
-	"wbr"
-};
-
 }
 
 class LexerHTML : public DefaultLexer {
@@ -1056,8 +1072,19 @@ class LexerHTML : public DefaultLexer {
 	WordList keywordsSGML; // SGML (DTD) keywords
 	OptionsHTML options;
 	OptionSetHTML osHTML;
-	std::set<std::string> nonFoldingTags;
 	SubStyles subStyles{styleSubable,SubStylesHTML,SubStylesAvailable,0};
+	// What the line states do not hold of the lexer state at the start of a line inside a tag
+	// or PHP string. Lexing resumes at the last checkpoint before such a line instead of going
+	// back to the start of the tag or string, which may be thousands of lines up for a heredoc.
+	struct Checkpoint {
+		Sci_Position lineStart = 0;	// To notice lines having moved since
+		int lineStatePrevious = 0;
+		bool tagDontFold = false;
+		std::string lastTag;
+		std::string phpStringDelimiter;
+	};
+	std::map<Sci_Position, Checkpoint> checkpoints;
+	const Checkpoint *CheckpointAt(Accessor &styler, Sci_Position pos) const;
 public:
 	explicit LexerHTML(bool isXml_, bool isPHPScript_) :
 		DefaultLexer(
@@ -1067,8 +1094,7 @@ public:
 			isXml_ ?  std::size(lexicalClassesXML) : std::size(lexicalClassesHTML)),
 		isXml(isXml_),
 		isPHPScript(isPHPScript_),
-		osHTML(isPHPScript_),
-		nonFoldingTags(std::begin(tagsThatDoNotFold), std::end(tagsThatDoNotFold)) {
+		osHTML(isPHPScript_) {
 	}
 	~LexerHTML() override {
 	}
@@ -1137,6 +1163,19 @@ public:
 	}
 };
 
+const LexerHTML::Checkpoint *LexerHTML::CheckpointAt(Accessor &styler, Sci_Position pos) const {
+	const Sci_Position line = styler.GetLine(pos);
+	if ((line % checkpointInterval) != 0) {
+		return nullptr;
+	}
+	const auto it = checkpoints.find(line);
+	if ((it == checkpoints.end()) || (it->second.lineStart != pos) ||
+		(it->second.lineStatePrevious != styler.GetLineState(line - 1))) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
 Sci_Position SCI_METHOD LexerHTML::PropertySet(const char *key, const char *val) {
 	if (osHTML.PropertySet(&options, key, val)) {
 		return 0;
@@ -1195,6 +1234,7 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 		initStyle = SCE_HPHP_DEFAULT;
 	}
 	std::string lastTag;
+	std::string tagAttribute;
 	std::string prevWord;
 	PhpNumberState phpNumber;
 	std::string phpStringDelimiter;
@@ -1203,10 +1243,19 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 	std::string makoBlockType;
 	int makoComment = 0;
 	std::string djangoBlockType;
+	bool tagDontFold = false; //some HTML tags should not be folded
 	// If inside a tag, it may be a script tag, so reread from the start of line starting tag to ensure any language tags are seen
 	// PHP string can be heredoc, must find a delimiter first. Reread from beginning of line containing the string, to get the correct lineState
+	// Stop at a checkpoint on the way, which has what rereading would have found.
 	if (StyleNeedsBacktrack(state)) {
 		while ((startPos > 0) && (StyleNeedsBacktrack(styler.StyleIndexAt(startPos - 1)))) {
+			const Checkpoint *checkpoint = CheckpointAt(styler, startPos);
+			if (checkpoint) {
+				tagDontFold = checkpoint->tagDontFold;
+				lastTag = checkpoint->lastTag;
+				phpStringDelimiter = checkpoint->phpStringDelimiter;
+				break;
+			}
 			const Sci_Position backLineStart = styler.LineStart(styler.GetLine(startPos-1));
 			length += startPos - backLineStart;
 			startPos = backLineStart;
@@ -1218,6 +1267,9 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 		}
 	}
 	styler.StartAt(startPos);
+	// Those after the start are saved again as they are reached
+	checkpoints.erase(checkpoints.upper_bound(styler.GetLine(startPos)), checkpoints.end());
+	Sci_Position checkpointPos = -1;
 
 	/* Nothing handles getting out of these, so we need not start in any of them.
 	 * As we're at line start and they can't span lines, we'll re-detect them anyway */
@@ -1245,7 +1297,6 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 
 	bool tagOpened = (lineState >> 2) & 0x01; // 1 bit to know if we are in an opened tag
 	bool tagClosing = (lineState >> 3) & 0x01; // 1 bit to know if we are in a closing tag
-	bool tagDontFold = false; //some HTML tags should not be folded
 	script_type aspScript = static_cast<script_type>((lineState >> 4) & 0x0F); // 4 bits of script name
 	script_type clientScript = static_cast<script_type>((lineState >> 8) & 0x0F); // 4 bits of script name
 	int beforePreProc = (lineState >> 12) & 0xFF; // 8 bits of state
@@ -1305,6 +1356,17 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 	styler.StartSegment(startPos);
 	const Sci_Position lengthDoc = startPos + length;
 	for (Sci_Position i = startPos; i < lengthDoc; i++) {
+		if ((checkpointPos >= 0) && (i >= checkpointPos)) {
+			if ((i == checkpointPos) && StyleNeedsBacktrack(state)) {
+				Checkpoint &checkpoint = checkpoints[lineCurrent];
+				checkpoint.lineStart = i;
+				checkpoint.lineStatePrevious = styler.GetLineState(lineCurrent - 1);
+				checkpoint.tagDontFold = tagDontFold;
+				checkpoint.lastTag = lastTag;
+				checkpoint.phpStringDelimiter = phpStringDelimiter;
+			}
+			checkpointPos = -1;
+		}
 		const int chPrev2 = chPrev;
 		chPrev = ch;
 		if (!IsASpace(ch) && state != SCE_HJ_COMMENT &&
@@ -1415,6 +1477,9 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 			                    (sgmlBlockLevel << 21));
 			lineCurrent++;
 			lineStartVisibleChars = 0;
+			if ((lineCurrent % checkpointInterval) == 0) {
+				checkpointPos = i + 1;
+			}
 		}
 
 		// handle start of Mako comment line
@@ -2001,7 +2066,7 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 		case SCE_H_TAGUNKNOWN:
 			if (!setTagContinue.Contains(ch) && !((ch == '/') && (chPrev == '<'))) {
 				int eClass = classifyTagHTML(styler.GetStartSegment(),
-					i - 1, keywordsHTML, classifierTags, styler, tagDontFold, caseSensitive, isXml, allowScripts, nonFoldingTags, lastTag);
+					i - 1, keywordsHTML, classifierTags, styler, tagDontFold, caseSensitive, isXml, allowScripts, lastTag);
 				if (eClass == SCE_H_SCRIPT || eClass == SCE_H_COMMENT) {
 					if (!tagClosing) {
 						inScriptType = eNonHtmlScript;
@@ -2055,7 +2120,7 @@ void SCI_METHOD LexerHTML::Lex(Sci_PositionU startPos, Sci_Position length, int
 			break;
 		case SCE_H_ATTRIBUTE:
 			if (!setAttributeContinue.Contains(ch)) {
-				isLanguageType = classifyAttribHTML(inScriptType, styler.GetStartSegment(), i - 1, keywordsHTML, classifierAttributes, styler, lastTag);
+				isLanguageType = classifyAttribHTML(inScriptType, styler.GetStartSegment(), i - 1, keywordsHTML, classifierAttributes, styler, lastTag, tagAttribute);
 				if (ch == '>') {
 					styler.ColourTo(i, SCE_H_TAG);
 					if (inScriptType == eNonHtmlScript) {
@@ -70,10 +70,24 @@ bool cmpWords(const char *a, const char *b) noexcept {
 	return strcmp(a, b) < 0;
 }
 
+// Lists with at least this many words are also indexed by a hash table as scanning
+// the words sharing a first character becomes slow, for example with the thousands
+// of type names of a project.
+constexpr size_t hashThreshold = 256;
+
+// FNV-1a
+size_t HashWord(std::string_view sv) noexcept {
+	size_t hash = 2166136261U;
+	for (const char ch : sv) {
+		hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619U;
+	}
+	return hash;
+}
+
 }
 
 WordList::WordList(bool onlyLineEnds_) noexcept :
-	words(nullptr), list(nullptr), len(0), onlyLineEnds(onlyLineEnds_) {
+	words(nullptr), list(nullptr), len(0), onlyLineEnds(onlyLineEnds_), hashTable(nullptr), hashMask(0) {
 	// Prevent warnings by static analyzers about uninitialized starts.
 	starts[0] = -1;
 }
@@ -105,6 +119,9 @@ void WordList::Clear() noexcept {
 	list = nullptr;
 	delete []words;
 	words = nullptr;
+	delete []hashTable;
+	hashTable = nullptr;
+	hashMask = 0;
 	len = 0;
 }
 
@@ -143,9 +160,34 @@ bool WordList::Set(const char *s, bool lowerCase) {
 		unsigned char const indexChar = words[l][0];
 		starts[indexChar] = l;
 	}
+	if (len >= hashThreshold) {
+		// Open addressing with linear probing, kept at most half full
+		size_t size = 1;
+		while (size < len * 2)
+			size *= 2;
+		std::unique_ptr<int[]> table = std::make_unique<int[]>(size);
+		std::fill(table.get(), table.get() + size, -1);
+		const size_t mask = size - 1;
+		for (size_t i = 0; i < len; i++) {
+			size_t slot = HashWord(words[i]) & mask;
+			while (table[slot] >= 0)
+				slot = (slot + 1) & mask;
+			table[slot] = static_cast<int>(i);
+		}
+		hashTable = table.release();
+		hashMask = mask;
+	}
 	return true;
 }
 
+bool WordList::InHashTable(std::string_view sv) const noexcept {
+	for (size_t slot = HashWord(sv) & hashMask; hashTable[slot] >= 0; slot = (slot + 1) & hashMask) {
+		if (sv == words[hashTable[slot]])
+			return true;
+	}
+	return false;
+}
+
 /** Check whether a string is in the list.
  * List elements are either exact matches or prefixes.
  * Prefix elements start with '^' and match all strings that start with the rest of the element
@@ -157,7 +199,10 @@ bool WordList::InList(const char *s) const noexcept {
 	const char first = s[0];
 	const unsigned char firstChar = first;
 	int j = starts[firstChar];
-	if (j >= 0) {
+	if (hashTable) {
+		if (InHashTable(s))
+			return true;
+	} else if (j >= 0) {
 		while (words[j][0] == first) {
 			if (s[1] == words[j][1]) {
 				const char *a = words[j] + 1;
@@ -197,7 +242,11 @@ bool WordList::InList(std::string_view sv) const noexcept {
 		return false;
 	const char first = sv[0];
 	const unsigned char firstChar = first;
-	if (int j = starts[firstChar]; j >= 0) {
+	if (hashTable) {
+		if (InHashTable(sv)) {
+			return true;
+		}
+	} else if (int j = starts[firstChar]; j >= 0) {
 		const std::string_view after = sv.substr(1);
 		for (; words[j][0] == first; j++) {
 			if (std::string_view(words[j] + 1) == after) {
@@ -19,6 +19,9 @@ class WordList {
 	size_t len;
 	bool onlyLineEnds;	///< Delimited by any white space or only line ends
 	int starts[256];
+	int *hashTable;	///< Word indices by hash for large lists, -1 for empty slots
+	size_t hashMask;
+	bool InHashTable(std::string_view sv) const noexcept;
 public:
 	explicit WordList(bool onlyLineEnds_ = false) noexcept;
 	// Deleted so WordList objects can not be copied.
@@ -0,0 +1,264 @@
+// Scintilla source code edit control
+/** @file BackgroundWrap.cxx
+ ** Wraps blocks of lines on layout threads while the editor carries on.
+ **
+ ** Starting a block copies the text and styles of its lines into a private document on the
+ ** calling thread, which is cheap next to measuring them. The threads of a block then only
+ ** touch that copy, a copy of the view style made when the style changes, and the block's own
+ ** view. They share its position cache, which is locked as when LayoutLine runs on several
+ ** threads, but nothing is shared with the editor or with other blocks.
+ ** Cancelled blocks are left to finish their current line and are dropped once they are
+ ** done rather than waited for; only destroying the BackgroundWrap waits for them.
+ **/
+// Copyright 2026 by The Geany contributors
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <forward_list>
+#include <optional>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <future>
+
+#include "ScintillaTypes.h"
+#include "ScintillaMessages.h"
+#include "ScintillaStructures.h"
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+#include "Geometry.h"
+#include "Platform.h"
+
+#include "CharacterType.h"
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "UniConversion.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "ElapsedPeriod.h"
+#include "BackgroundWrap.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+// The model a block is laid out with, whose document holds a copy of the block's lines.
+class BlockModel : public EditModel {
+public:
+	Sci::Line TopLineOfMain() const noexcept override {
+		return 0;
+	}
+	Point GetVisibleOriginInMain() const override {
+		return Point();
+	}
+	Sci::Line LinesOnScreen() const override {
+		return 1;
+	}
+};
+
+}
+
+struct BackgroundWrap::Block {
+	BlockModel model;
+	// Its position cache is keyed by font, so it must not outlive vs, nor be shared with a
+	// block using another style whose fonts could reuse the same addresses.
+	EditView view;
+	std::shared_ptr<ViewStyle> vs;
+	std::shared_ptr<Surface> surface;
+	Sci::Line lineStart = 0;
+	Sci::Line lineEnd = 0;
+	int width = 0;
+	std::vector<int> linesAfterWrap;
+	std::vector<double> durations;
+	std::atomic<bool> cancelled = false;
+	std::atomic<size_t> nextIndex = 0;
+	std::vector<std::future<void>> futures;
+
+	Block() {
+		// Lines are spread over threads by the block, not inside LayoutLine.
+		view.SetLayoutThreads(1);
+	}
+	Block(const Block &) = delete;
+	Block(Block &&) = delete;
+	Block &operator=(const Block &) = delete;
+	Block &operator=(Block &&) = delete;
+	~Block() {
+		cancelled.store(true, std::memory_order_relaxed);
+		for (const std::future<void> &f : futures) {
+			if (f.valid()) {
+				f.wait();
+			}
+		}
+	}
+
+	bool Running() const {
+		return std::any_of(futures.cbegin(), futures.cend(), [](const std::future<void> &f) {
+			return f.valid() && (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+		});
+	}
+
+	void Wrap(size_t thread) {
+		ElapsedPeriod epWrapping;
+		// Reused for all the lines, avoiding allocation costs.
+		LineLayout ll(-1, 200);
+		while (!cancelled.load(std::memory_order_relaxed)) {
+			const size_t i = nextIndex.fetch_add(1, std::memory_order_acq_rel);
+			if (i >= linesAfterWrap.size()) {
+				break;
+			}
+			const Sci::Line line = static_cast<Sci::Line>(i);
+			ll.ReSet(line, model.pdoc->LineRange(line).Length());
+			// Always measured as on several threads, since this is not the thread owning the surface
+			view.LayoutLine(model, surface.get(), *vs, &ll, width, true);
+			linesAfterWrap[i] = ll.lines;
+		}
+		durations[thread] = epWrapping.Duration();
+	}
+};
+
+BackgroundWrap::BackgroundWrap() = default;
+
+BackgroundWrap::~BackgroundWrap() = default;
+
+void BackgroundWrap::DropCancelled() {
+	blocksCancelled.erase(std::remove_if(blocksCancelled.begin(), blocksCancelled.end(),
+		[](const std::unique_ptr<Block> &b) {
+		return !b->Running();
+	}), blocksCancelled.end());
+}
+
+bool BackgroundWrap::StyleValid() const noexcept {
+	return vs && surface;
+}
+
+void BackgroundWrap::InvalidateStyle() noexcept {
+	// Blocks being wrapped keep their own references
+	vs.reset();
+	surface.reset();
+}
+
+void BackgroundWrap::SetStyle(std::unique_ptr<Surface> surface_, const ViewStyle &vsSource, int tabInChars) {
+	std::shared_ptr<ViewStyle> vsNew = std::make_shared<ViewStyle>(vsSource);
+	vsNew->Refresh(*surface_, tabInChars);
+	surface = std::move(surface_);
+	vs = std::move(vsNew);
+}
+
+bool BackgroundWrap::Pending() const noexcept {
+	return block != nullptr;
+}
+
+bool BackgroundWrap::Running() const {
+	return block && block->Running();
+}
+
+void BackgroundWrap::Start(const EditModel &model, Sci::Line lineStart, Sci::Line lineEnd, int width, unsigned int threads) {
+	PLATFORM_ASSERT(!block && StyleValid() && (lineStart < lineEnd));
+	DropCancelled();
+
+	std::unique_ptr<Block> blockNew = std::make_unique<Block>();
+	blockNew->vs = vs;
+	blockNew->surface = surface;
+	blockNew->lineStart = lineStart;
+	blockNew->lineEnd = lineEnd;
+	blockNew->width = width;
+
+	Document *pdocBlock = blockNew->model.pdoc;
+	pdocBlock->SetDBCSCodePage(model.pdoc->dbcsCodePage);
+	pdocBlock->tabInChars = model.pdoc->tabInChars;
+	pdocBlock->indentInChars = model.pdoc->indentInChars;
+	pdocBlock->SetUndoCollection(false);
+	*blockNew->model.reprs = *model.reprs;
+
+	const Sci::Position posStart = model.pdoc->LineStart(lineStart);
+	const Sci::Position length = model.pdoc->LineStart(lineEnd) - posStart;
+	std::string text(static_cast<size_t>(length), '\0');
+	model.pdoc->GetCharRange(text.data(), posStart, length);
+	pdocBlock->InsertString(0, text);
+	text.clear();
+	text.shrink_to_fit();
+	std::vector<unsigned char> styles(static_cast<size_t>(length));
+	model.pdoc->GetStyleRange(styles.data(), posStart, length);
+	pdocBlock->StartStyling(0);
+	pdocBlock->SetStyles(length, reinterpret_cast<const char *>(styles.data()));
+
+	const size_t lines = static_cast<size_t>(lineEnd - lineStart);
+	blockNew->linesAfterWrap.resize(lines, 1);
+	threads = static_cast<unsigned int>(std::clamp<size_t>(threads, 1, lines));
+	blockNew->durations.resize(threads);
+	Block *b = blockNew.get();
+	for (size_t th = 0; th < threads; th++) {
+		blockNew->futures.push_back(std::async(std::launch::async, [b, th]() {
+			b->Wrap(th);
+		}));
+	}
+	block = std::move(blockNew);
+}
+
+void BackgroundWrap::Cancel(Sci::Line lineFrom) {
+	// Changes before the block move its lines so only those after it leave it valid
+	if (block && (lineFrom < block->lineEnd)) {
+		block->cancelled.store(true, std::memory_order_relaxed);
+		blocksCancelled.push_back(std::move(block));
+	}
+	DropCancelled();
+}
+
+std::optional<BackgroundWrap::Result> BackgroundWrap::Collect(bool wait) {
+	DropCancelled();
+	if (!block || (!wait && block->Running())) {
+		return {};
+	}
+	const std::unique_ptr<Block> blockDone = std::move(block);
+	for (std::future<void> &f : blockDone->futures) {
+		// Rethrows what a thread failed with, such as std::bad_alloc
+		f.get();
+	}
+	Result result;
+	result.lineStart = blockDone->lineStart;
+	result.width = blockDone->width;
+	result.linesAfterWrap = std::move(blockDone->linesAfterWrap);
+	result.bytes = blockDone->model.pdoc->Length();
+	for (const double duration : blockDone->durations) {
+		result.duration += duration;
+	}
+	return result;
+}
@@ -0,0 +1,63 @@
+// Scintilla source code edit control
+/** @file BackgroundWrap.h
+ ** Wraps blocks of lines on layout threads while the editor carries on.
+ **/
+// Copyright 2026 by The Geany contributors
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef BACKGROUNDWRAP_H
+#define BACKGROUNDWRAP_H
+
+namespace Scintilla::Internal {
+
+/**
+ * The lines of a block are laid out from a private copy of their text and styles, with a
+ * copy of the view style, so the document and view may change while the block is wrapped.
+ * The editor cancels blocks made stale by such changes and commits the rest itself.
+ */
+class BackgroundWrap {
+public:
+	struct Result {
+		Sci::Line lineStart = 0;
+		int width = 0;
+		std::vector<int> linesAfterWrap;	// Display lines of each document line from lineStart
+		size_t bytes = 0;
+		double duration = 0.0;	// Summed over the threads
+	};
+private:
+	struct Block;
+	std::shared_ptr<ViewStyle> vs;
+	std::shared_ptr<Surface> surface;
+	std::unique_ptr<Block> block;
+	// Cancelled blocks whose threads may still be finishing their current line
+	std::vector<std::unique_ptr<Block>> blocksCancelled;
+	void DropCancelled();
+public:
+	BackgroundWrap();
+	// Deleted so BackgroundWrap objects can not be copied.
+	BackgroundWrap(const BackgroundWrap &) = delete;
+	BackgroundWrap(BackgroundWrap &&) = delete;
+	BackgroundWrap &operator=(const BackgroundWrap &) = delete;
+	BackgroundWrap &operator=(BackgroundWrap &&) = delete;
+	~BackgroundWrap();
+
+	bool StyleValid() const noexcept;
+	void InvalidateStyle() noexcept;
+	/// Copy the view style, measuring its fonts with surface_ which is then used by the threads.
+	void SetStyle(std::unique_ptr<Surface> surface_, const ViewStyle &vsSource, int tabInChars);
+
+	/// Whether a block was started and not yet committed or cancelled.
+	bool Pending() const noexcept;
+	/// Whether the threads of the pending block are still working.
+	bool Running() const;
+	/// Start wrapping the lines from lineStart to lineEnd of model at width on threads threads.
+	void Start(const EditModel &model, Sci::Line lineStart, Sci::Line lineEnd, int width, unsigned int threads);
+	/// Cancel the pending block unless it ends before lineFrom.
+	void Cancel(Sci::Line lineFrom=0);
+	/// Take the result of the pending block, waiting for it or only when it is finished.
+	std::optional<Result> Collect(bool wait);
+};
+
+}
+
+#endif
@@ -333,7 +333,7 @@ public:
 };
 
 CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_) :
-	hasStyles(hasStyles_), largeDocument(largeDocument_) {
+	hasStyles(hasStyles_), largeDocument(largeDocument_), stylesAllocated(false) {
 	readOnly = false;
 	utf8Substance = false;
 	utf8LineEnds = LineEndType::Default;
@@ -371,7 +371,7 @@ void CellBuffer::GetCharRange(char *buffer, Sci::Position position, Sci::Positio
 }
 
 char CellBuffer::StyleAt(Sci::Position position) const noexcept {
-	return hasStyles ? style.ValueAt(position) : '\0';
+	return stylesAllocated ? style.ValueAt(position) : '\0';
 }
 
 void CellBuffer::GetStyleRange(unsigned char *buffer, Sci::Position position, Sci::Position lengthRetrieve) const {
@@ -379,7 +379,7 @@ void CellBuffer::GetStyleRange(unsigned char *buffer, Sci::Position position, Sc
 		return;
 	if (position < 0)
 		return;
-	if (!hasStyles) {
+	if (!stylesAllocated) {
 		std::fill(buffer, buffer + lengthRetrieve, static_cast<unsigned char>(0));
 		return;
 	}
@@ -439,8 +439,27 @@ const char *CellBuffer::InsertString(Sci::Position position, const char *s, Sci:
 	return data;
 }
 
+// Styles are all 0 until allocated, so setting 0 doesn't need them.
+// When they can't be allocated, the document stays unstyled.
+bool CellBuffer::AllocateStyles() noexcept {
+	if (!stylesAllocated) {
+		try {
+			style.InsertValue(0, substance.Length(), 0);
+			stylesAllocated = true;
+		} catch (...) {
+			ReleaseStyles();
+		}
+	}
+	return stylesAllocated;
+}
+
+void CellBuffer::ReleaseStyles() noexcept {
+	style = SplitVector<char>();
+	stylesAllocated = false;
+}
+
 bool CellBuffer::SetStyleAt(Sci::Position position, char styleValue) noexcept {
-	if (!hasStyles) {
+	if (!hasStyles || (!stylesAllocated && styleValue == 0) || !AllocateStyles()) {
 		return false;
 	}
 	const char curVal = style.ValueAt(position);
@@ -453,12 +472,20 @@ bool CellBuffer::SetStyleAt(Sci::Position position, char styleValue) noexcept {
 }
 
 bool CellBuffer::SetStyleFor(Sci::Position position, Sci::Position lengthStyle, char styleValue) noexcept {
-	if (!hasStyles) {
+	if (!hasStyles || (!stylesAllocated && styleValue == 0) || !AllocateStyles()) {
 		return false;
 	}
 	bool changed = false;
 	PLATFORM_ASSERT(lengthStyle == 0 ||
 		(lengthStyle > 0 && lengthStyle + position <= style.Length()));
+	if (styleValue == 0 && position == 0 && lengthStyle == style.Length()) {
+		// Clearing all styles returns to the unallocated state
+		for (Sci::Position pos = 0; pos < lengthStyle && !changed; pos++) {
+			changed = style.ValueAt(pos) != 0;
+		}
+		ReleaseStyles();
+		return changed;
+	}
 	while (lengthStyle--) {
 		const char curVal = style.ValueAt(position);
 		if (curVal != styleValue) {
@@ -502,7 +529,7 @@ void CellBuffer::Allocate(Sci::Position newSize) {
 		throw std::runtime_error("CellBuffer::Allocate: size of standard document limited to 2G.");
 	}
 	substance.ReAllocate(newSize);
-	if (hasStyles) {
+	if (stylesAllocated) {
 		style.ReAllocate(newSize);
 	}
 }
@@ -631,6 +658,10 @@ bool CellBuffer::HasStyles() const noexcept {
 	return hasStyles;
 }
 
+bool CellBuffer::StylesAllocated() const noexcept {
+	return stylesAllocated;
+}
+
 void CellBuffer::SetSavePoint() {
 	uh->SetSavePoint();
 	if (changeHistory) {
@@ -650,7 +681,7 @@ void CellBuffer::TentativeCommit() noexcept {
 	uh->TentativeCommit();
 }
 
-int CellBuffer::TentativeSteps() noexcept {
+int CellBuffer::TentativeSteps() {
 	return uh->TentativeSteps();
 }
 
@@ -810,7 +841,7 @@ void CellBuffer::BasicInsertString(Sci::Position position, const char *s, Sci::P
 	}
 
 	substance.InsertFromArray(position, s, 0, insertLength);
-	if (hasStyles) {
+	if (stylesAllocated) {
 		style.InsertValue(position, insertLength, 0);
 	}
 
@@ -948,7 +979,10 @@ void CellBuffer::BasicInsertString(Sci::Position position, const char *s, Sci::P
 			const CountWidths cw = CountCharacterWidthsUTF8(std::string_view(s, insertLength));
 			plv->InsertCharacters(linePosition, cw);
 		} else {
-			RecalculateIndexLineStarts(linePosition, lineInsert - 1);
+			// Line ends may have been joined or split with the line before, as for "\r" + "\n",
+			// so its width may have changed as well as the widths of the following lines
+			RecalculateIndexLineStarts(std::max<Sci::Line>(linePosition - 1, 0),
+				std::min(lineInsert, Lines() - 1));
 		}
 	}
 }
@@ -1047,9 +1081,11 @@ void CellBuffer::BasicDeleteChars(Sci::Position position, Sci::Position deleteLe
 	}
 	substance.DeleteRange(position, deleteLength);
 	if (lineRecalculateStart >= 0) {
-		RecalculateIndexLineStarts(lineRecalculateStart, lineRecalculateStart);
+		// Removing one of a "\r\n" pair or joining one moves the end of the line before
+		RecalculateIndexLineStarts(std::max<Sci::Line>(lineRecalculateStart - 1, 0),
+			std::min(lineRecalculateStart + 1, Lines() - 1));
 	}
-	if (hasStyles) {
+	if (stylesAllocated) {
 		style.DeleteRange(position, deleteLength);
 	}
 }
@@ -1089,11 +1125,15 @@ void CellBuffer::DeleteUndoHistory() noexcept {
 	uh->DeleteUndoHistory();
 }
 
+void CellBuffer::SetUndoMemoryLimit(size_t limit) noexcept {
+	uh->SetMemoryLimit(limit);
+}
+
 bool CellBuffer::CanUndo() const noexcept {
 	return uh->CanUndo();
 }
 
-int CellBuffer::StartUndo() noexcept {
+int CellBuffer::StartUndo() {
 	return uh->StartUndo();
 }
 
@@ -1131,7 +1171,7 @@ bool CellBuffer::CanRedo() const noexcept {
 	return uh->CanRedo();
 }
 
-int CellBuffer::StartRedo() noexcept {
+int CellBuffer::StartRedo() {
 	return uh->StartRedo();
 }
 
@@ -77,7 +77,9 @@ private:
 	bool hasStyles;
 	bool largeDocument;
 	SplitVector<char> substance;
+	/// Only allocated once a non-default style is set, so unstyled text takes no memory for styles
 	SplitVector<char> style;
+	bool stylesAllocated;
 	bool readOnly;
 	bool utf8Substance;
 	Scintilla::LineEndType utf8LineEnds;
@@ -94,6 +96,8 @@ private:
 	void ResetLineEnds();
 	void RecalculateIndexLineStarts(Sci::Line lineFirst, Sci::Line lineLast);
 	bool MaintainingLineCharacterIndex() const noexcept;
+	bool AllocateStyles() noexcept;
+	void ReleaseStyles() noexcept;
 	/// Actions without undo
 	void BasicInsertString(Sci::Position position, const char *s, Sci::Position insertLength);
 	void BasicDeleteChars(Sci::Position position, Sci::Position deleteLength);
@@ -151,6 +155,7 @@ public:
 	void SetReadOnly(bool set) noexcept;
 	bool IsLarge() const noexcept;
 	bool HasStyles() const noexcept;
+	bool StylesAllocated() const noexcept;
 
 	/// The save point is a marker in the undo stack where the container has stated that
 	/// the buffer was saved. Undo and redo can move over the save point.
@@ -160,7 +165,7 @@ public:
 	void TentativeStart() noexcept;
 	void TentativeCommit() noexcept;
 	bool TentativeActive() const noexcept;
-	int TentativeSteps() noexcept;
+	int TentativeSteps();
 
 	bool SetUndoCollection(bool collectUndo) noexcept;
 	bool IsCollectingUndo() const noexcept;
@@ -170,15 +175,16 @@ public:
 	bool AfterUndoSequenceStart() const noexcept;
 	void AddUndoAction(Sci::Position token, bool mayCoalesce);
 	void DeleteUndoHistory() noexcept;
+	void SetUndoMemoryLimit(size_t limit) noexcept;
 
 	/// To perform an undo, StartUndo is called to retrieve the number of steps, then UndoStep is
 	/// called that many times. Similarly for redo.
 	bool CanUndo() const noexcept;
-	int StartUndo() noexcept;
+	int StartUndo();
 	Action GetUndoStep() const noexcept;
 	void PerformUndoStep();
 	bool CanRedo() const noexcept;
-	int StartRedo() noexcept;
+	int StartRedo();
 	Action GetRedoStep() const noexcept;
 	void PerformRedoStep();
 
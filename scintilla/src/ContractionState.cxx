@@ -82,6 +82,7 @@ public:
 	bool GetExpanded(Sci::Line lineDoc) const noexcept override;
 	bool SetExpanded(Sci::Line lineDoc, bool isExpanded) override;
 	bool ExpandAll() override;
+	bool ExpandRange(Sci::Line lineDocStart, Sci::Line lineDocEnd) override;
 	Sci::Line ContractedNext(Sci::Line lineDocStart) const noexcept override;
 
 	int GetHeight(Sci::Line lineDoc) const noexcept override;
@@ -216,10 +217,27 @@ template <typename LINE>
 void ContractionState<LINE>::InsertLines(Sci::Line lineDoc, Sci::Line lineCount) {
 	if (OneToOne()) {
 		linesInDocument += line_cast(lineCount);
-	} else {
-		for (Sci::Line l = 0; l < lineCount; l++) {
-			InsertLine(lineDoc + l);
+	} else if (lineCount == 1) {
+		InsertLine(lineDoc);
+	} else if (lineCount > 0) {
+		// Insert all the lines at once, visible, expanded and one display line high,
+		// as line by line is slow when switching a big document out of OneToOne
+		const LINE lineDocCast = line_cast(lineDoc);
+		const LINE lineCountCast = line_cast(lineCount);
+		visible->InsertSpace(lineDocCast, lineCountCast);
+		visible->FillRange(lineDocCast, 1, lineCountCast);
+		expanded->InsertSpace(lineDocCast, lineCountCast);
+		expanded->FillRange(lineDocCast, 1, lineCountCast);
+		heights->InsertSpace(lineDocCast, lineCountCast);
+		heights->FillRange(lineDocCast, 1, lineCountCast);
+		foldDisplayTexts->InsertSpace(lineDocCast, lineCountCast);
+		const LINE lineDisplay = line_cast(DisplayFromDoc(lineDoc));
+		std::vector<LINE> lineStarts(lineCount);
+		for (LINE l = 0; l < lineCountCast; l++) {
+			lineStarts[l] = lineDisplay + l;
 		}
+		displayLines->InsertPartitions(lineDocCast, lineStarts.data(), lineStarts.size());
+		displayLines->InsertText(lineDocCast + lineCountCast - 1, lineCountCast);
 	}
 	Check();
 }
@@ -256,13 +274,19 @@ bool ContractionState<LINE>::SetVisible(Sci::Line lineDocStart, Sci::Line lineDo
 		Check();
 		if ((lineDocStart <= lineDocEnd) && (lineDocStart >= 0) && (lineDocEnd < LinesInDoc())) {
 			bool changed = false;
-			for (Sci::Line line = lineDocStart; line <= lineDocEnd; line++) {
+			// Skip whole runs of lines that already have the wanted visibility
+			Sci::Line line = lineDocStart;
+			while (line <= lineDocEnd) {
+				const Sci::Line lineEndRun = std::min<Sci::Line>(visible->EndRun(line_cast(line)), lineDocEnd + 1);
 				if (GetVisible(line) != isVisible) {
 					changed = true;
-					const int heightLine = heights->ValueAt(line_cast(line));
-					const int difference = isVisible ? heightLine : -heightLine;
-					displayLines->InsertText(line_cast(line), difference);
+					for (; line < lineEndRun; line++) {
+						const int heightLine = heights->ValueAt(line_cast(line));
+						const int difference = isVisible ? heightLine : -heightLine;
+						displayLines->InsertText(line_cast(line), difference);
+					}
 				}
+				line = lineEndRun;
 			}
 			if (changed) {
 				visible->FillRange(line_cast(lineDocStart), isVisible ? 1 : 0,
@@ -345,6 +369,20 @@ bool ContractionState<LINE>::ExpandAll() {
 	}
 }
 
+template <typename LINE>
+bool ContractionState<LINE>::ExpandRange(Sci::Line lineDocStart, Sci::Line lineDocEnd) {
+	if (OneToOne()) {
+		return false;
+	} else if ((lineDocStart <= lineDocEnd) && (lineDocStart >= 0) && (lineDocEnd < LinesInDoc())) {
+		const bool changed = expanded->FillRange(line_cast(lineDocStart), 1,
+			line_cast(lineDocEnd - lineDocStart) + 1).changed;
+		Check();
+		return changed;
+	} else {
+		return false;
+	}
+}
+
 template <typename LINE>
 Sci::Line ContractionState<LINE>::ContractedNext(Sci::Line lineDocStart) const noexcept {
 	if (OneToOne()) {
@@ -38,6 +38,8 @@ public:
 	virtual bool GetExpanded(Sci::Line lineDoc) const noexcept=0;
 	virtual bool SetExpanded(Sci::Line lineDoc, bool isExpanded)=0;
 	virtual bool ExpandAll()=0;
+	// Expands every line from lineDocStart to lineDocEnd, both included
+	virtual bool ExpandRange(Sci::Line lineDocStart, Sci::Line lineDocEnd)=0;
 	virtual Sci::Line ContractedNext(Sci::Line lineDocStart) const noexcept =0;
 
 	virtual int GetHeight(Sci::Line lineDoc) const noexcept=0;
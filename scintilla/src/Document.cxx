@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <memory>
 #include <chrono>
+#include <mutex>
 
 #ifndef NO_CXX11_REGEX
 #include <regex>
@@ -59,13 +60,21 @@ using namespace Scintilla::Internal;
 #pragma GCC diagnostic ignored "-Wstringop-overflow"
 #endif
 
-LexInterface::LexInterface(Document *pdoc_) noexcept : pdoc(pdoc_), performingStyle(false) {
+LexInterface::LexInterface(Document *pdoc_) noexcept : pdoc(pdoc_), performingStyle(false),
+	lexerFactory(nullptr), parallelThreads(1), parallelBroken(false) {
 }
 
 LexInterface::~LexInterface() noexcept = default;
 
 void LexInterface::SetInstance(ILexer5 *instance_) noexcept {
 	instance.reset(instance_);
+	setupSteps.clear();
+	parallelBroken = false;
+}
+
+void LexInterface::SetParallelLexing(unsigned int threads, LexerFactory factory) noexcept {
+	parallelThreads = threads;
+	lexerFactory = factory;
 }
 
 void LexInterface::Colourise(Sci::Position start, Sci::Position end) {
@@ -88,7 +97,8 @@ void LexInterface::Colourise(Sci::Position start, Sci::Position end) {
 			styleStart = pdoc->StyleAt(start - 1);
 
 		if (len > 0) {
-			instance->Lex(start, len, styleStart, pdoc);
+			if (!ColouriseParallel(start, end, styleStart))
+				instance->Lex(start, len, styleStart, pdoc);
 			instance->Fold(start, len, styleStart, pdoc);
 		}
 
@@ -148,6 +158,99 @@ CharacterExtracted::CharacterExtracted(const unsigned char *charBytes, size_t wi
 	}
 }
 
+constexpr Sci::Position NextTab(Sci::Position pos, Sci::Position tabSize) noexcept {
+	return ((pos / tabSize) + 1) * tabSize;
+}
+
+namespace Scintilla::Internal {
+
+// Checkpoints of the column and character count every step bytes along one long line
+// so that GetColumn, FindColumn and CountCharacters don't have to walk from the start
+// of the line each time. Built as far as queries need and truncated on modification.
+// Locked as FindColumn is also called by layout threads.
+class ColumnCache {
+public:
+	struct Checkpoint {
+		Sci::Position position;
+		Sci::Position column;
+		Sci::Position characters;
+	};
+	static constexpr Sci::Position step = 1024;
+
+	static bool Wanted(const Document *pdoc, Sci::Line line) noexcept {
+		return pdoc->LineEnd(line) - pdoc->LineStart(line) >= 2 * step;
+	}
+
+	// Moves checkpoint over one character the same way as GetColumn and CountCharacters.
+	static void Advance(const Document *pdoc, Checkpoint &cp) noexcept {
+		const char ch = pdoc->CharAt(cp.position);
+		cp.column = (ch == '\t') ? NextTab(cp.column, pdoc->tabInChars) : cp.column + 1;
+		cp.position = UTF8IsAscii(ch) ? cp.position + 1 : pdoc->NextPosition(cp.position, 1);
+		cp.characters++;
+	}
+
+	// Returns the last checkpoint of line at or before position or, when position is
+	// negative, the last one with a column not after column.
+	Checkpoint Find(const Document *pdoc, Sci::Line line_, Sci::Position position, Sci::Position column) {
+		std::lock_guard<std::mutex> guard(mutex);
+		if (line != line_ || tabInChars != pdoc->tabInChars || checkpoints.empty()) {
+			line = line_;
+			tabInChars = pdoc->tabInChars;
+			complete = false;
+			checkpoints.assign(1, Checkpoint{ pdoc->LineStart(line), 0, 0 });
+		}
+		const Sci::Position lineEnd = pdoc->LineEnd(line);
+		while (!complete && ((position >= 0) ?
+			(checkpoints.back().position + step <= position) : (checkpoints.back().column < column))) {
+			Checkpoint cp = checkpoints.back();
+			const Sci::Position next = cp.position + step;
+			while (cp.position < next && cp.position < lineEnd) {
+				Advance(pdoc, cp);
+			}
+			if (cp.position >= next) {
+				checkpoints.push_back(cp);
+			} else {
+				complete = true;
+			}
+		}
+		const auto it = (position >= 0) ?
+			std::upper_bound(checkpoints.begin(), checkpoints.end(), position,
+				[](Sci::Position pos, const Checkpoint &cp) noexcept { return pos < cp.position; }) :
+			std::upper_bound(checkpoints.begin(), checkpoints.end(), column,
+				[](Sci::Position col, const Checkpoint &cp) noexcept { return col < cp.column; });
+		return (it == checkpoints.begin()) ? checkpoints.front() : *(it - 1);
+	}
+
+	// Text changed from position so drop the checkpoints from it. A change may also join or
+	// split a multi-byte character started up to UTF8MaxBytes - 1 bytes before it, so that a
+	// checkpoint there could be inside a character.
+	void Invalidate(Sci::Position position) {
+		std::lock_guard<std::mutex> guard(mutex);
+		if (checkpoints.empty()) {
+			return;
+		}
+		const Sci::Position first = position - (UTF8MaxBytes - 1);
+		if (first <= checkpoints.front().position) {
+			checkpoints.clear();
+			line = -1;
+		} else {
+			while (checkpoints.back().position >= first) {
+				checkpoints.pop_back();
+			}
+			complete = false;
+		}
+	}
+
+private:
+	std::mutex mutex;
+	Sci::Line line = -1;
+	int tabInChars = 0;
+	bool complete = false;
+	std::vector<Checkpoint> checkpoints;
+};
+
+}
+
 Document::Document(DocumentOption options) :
 	refCount(0),
 	cb(!FlagSet(options, DocumentOption::StylesNone), FlagSet(options, DocumentOption::TextLarge)),
@@ -181,6 +284,8 @@ Document::Document(DocumentOption options) :
 
 	decorations = DecorationListCreate(IsLarge());
 
+	columnCache = std::make_unique<ColumnCache>();
+
 	cb.SetPerLine(this);
 	cb.SetUTF8Substance(CpUtf8 == dbcsCodePage);
 }
@@ -302,7 +407,14 @@ void Document::TentativeUndo() {
 		if (!cb.IsReadOnly()) {
 			const bool startSavePoint = cb.IsSavePoint();
 			bool multiLine = false;
-			const int steps = cb.TentativeSteps();
+			int steps = 0;
+			try {
+				steps = cb.TentativeSteps();
+			} catch (...) {
+				// The undo text could not be brought back into memory, nothing has changed yet
+				enteredModification--;
+				throw;
+			}
 			//Platform::DebugPrintf("Steps=%d\n", steps);
 			for (int step = 0; step < steps; step++) {
 				const Sci::Line prevLinesTotal = LinesTotal();
@@ -1282,10 +1394,6 @@ CharacterExtracted LastCharacter(std::string_view text) noexcept {
 		static_cast<unsigned int>(utf8status & UTF8MaskWidth) };
 }
 
-constexpr Sci::Position NextTab(Sci::Position pos, Sci::Position tabSize) noexcept {
-	return ((pos / tabSize) + 1) * tabSize;
-}
-
 std::string CreateIndentation(Sci::Position indent, int tabSize, bool insertSpaces) {
 	std::string indentation;
 	if (!insertSpaces) {
@@ -1409,9 +1517,10 @@ EncodingFamily Document::CodePageFamily() const noexcept {
 	return EncodingFamily::eightBit;
 }
 
-void Document::ModifiedAt(Sci::Position pos) noexcept {
+void Document::ModifiedAt(Sci::Position pos) {
 	if (endStyled > pos)
 		endStyled = pos;
+	columnCache->Invalidate(pos);
 }
 
 void Document::CheckReadOnly() {
@@ -1462,6 +1571,8 @@ bool Document::DeleteChars(Sci::Position pos, Sci::Position len) {
 		const bool startSavePoint = cb.IsSavePoint();
 		bool startSequence = false;
 		const char *text = cb.DeleteChars(pos, len, startSequence);
+		// Before the save point notification which may ask for columns
+		columnCache->Invalidate(pos);
 		if (startSavePoint && cb.IsCollectingUndo())
 			NotifySavePoint(false);
 		if ((pos < LengthNoExcept()) || (pos == 0))
@@ -1518,6 +1629,8 @@ Sci::Position Document::InsertString(Sci::Position position, const char *s, Sci:
 	const bool startSavePoint = cb.IsSavePoint();
 	bool startSequence = false;
 	const char *text = cb.InsertString(position, s, insertLength, startSequence);
+	// Before the save point notification which may ask for columns
+	columnCache->Invalidate(position);
 	if (startSavePoint && cb.IsCollectingUndo())
 		NotifySavePoint(false);
 	ModifiedAt(position);
@@ -1571,7 +1684,14 @@ Sci::Position Document::Undo() {
 		if (!cb.IsReadOnly()) {
 			const bool startSavePoint = cb.IsSavePoint();
 			bool multiLine = false;
-			const int steps = cb.StartUndo();
+			int steps = 0;
+			try {
+				steps = cb.StartUndo();
+			} catch (...) {
+				// The undo text could not be brought back into memory, nothing has changed yet
+				enteredModification--;
+				throw;
+			}
 			//Platform::DebugPrintf("Steps=%d\n", steps);
 			Range coalescedRemove;	// Default is empty at 0
 			for (int step = 0; step < steps; step++) {
@@ -1640,7 +1760,14 @@ Sci::Position Document::Redo() {
 		if (!cb.IsReadOnly()) {
 			const bool startSavePoint = cb.IsSavePoint();
 			bool multiLine = false;
-			const int steps = cb.StartRedo();
+			int steps = 0;
+			try {
+				steps = cb.StartRedo();
+			} catch (...) {
+				// The undo text could not be brought back into memory, nothing has changed yet
+				enteredModification--;
+				throw;
+			}
 			for (int step = 0; step < steps; step++) {
 				const Sci::Line prevLinesTotal = LinesTotal();
 				const Action action = cb.GetRedoStep();
@@ -1776,7 +1903,13 @@ Sci::Position Document::GetColumn(Sci::Position pos) const {
 	Sci::Position column = 0;
 	const Sci::Line line = SciLineFromPosition(pos);
 	if ((line >= 0) && (line < LinesTotal())) {
-		for (Sci::Position i = LineStart(line); i < pos;) {
+		Sci::Position i = LineStart(line);
+		if (ColumnCache::Wanted(this, line)) {
+			const ColumnCache::Checkpoint cp = columnCache->Find(this, line, pos, 0);
+			i = cp.position;
+			column = cp.column;
+		}
+		while (i < pos) {
 			const char ch = cb.CharAt(i);
 			if (ch == '\t') {
 				column = NextTab(column, tabInChars);
@@ -1799,9 +1932,35 @@ Sci::Position Document::GetColumn(Sci::Position pos) const {
 	return column;
 }
 
+// Number of characters from the start of line to pos, or -1 if pos isn't reached
+// by stepping over characters from the start of the line.
+Sci::Position Document::CharactersFromLineStart(Sci::Line line, Sci::Position pos) const {
+	ColumnCache::Checkpoint cp { LineStart(line), 0, 0 };
+	if (ColumnCache::Wanted(this, line)) {
+		cp = columnCache->Find(this, line, pos, 0);
+	}
+	while (cp.position < pos) {
+		cp.characters++;
+		cp.position = NextPosition(cp.position, 1);
+	}
+	return (cp.position == pos) ? cp.characters : -1;
+}
+
 Sci::Position Document::CountCharacters(Sci::Position startPos, Sci::Position endPos) const noexcept {
 	startPos = MovePositionOutsideChar(startPos, 1, false);
 	endPos = MovePositionOutsideChar(endPos, -1, false);
+	const Sci::Line line = SciLineFromPosition(startPos);
+	if (startPos < endPos && line == SciLineFromPosition(endPos) && ColumnCache::Wanted(this, line)) {
+		try {
+			const Sci::Position charactersStart = CharactersFromLineStart(line, startPos);
+			const Sci::Position charactersEnd = CharactersFromLineStart(line, endPos);
+			if (charactersStart >= 0 && charactersEnd >= 0) {
+				return charactersEnd - charactersStart;
+			}
+		} catch (...) {
+			// Fall back to counting each character
+		}
+	}
 	Sci::Position count = 0;
 	Sci::Position i = startPos;
 	while (i < endPos) {
@@ -1830,6 +1989,11 @@ Sci::Position Document::FindColumn(Sci::Line line, Sci::Position column) {
 	Sci::Position position = LineStart(line);
 	if ((line >= 0) && (line < LinesTotal())) {
 		Sci::Position columnCurrent = 0;
+		if (ColumnCache::Wanted(this, line)) {
+			const ColumnCache::Checkpoint cp = columnCache->Find(this, line, -1, column);
+			position = cp.position;
+			columnCurrent = cp.column;
+		}
 		while ((columnCurrent < column) && (position < Length())) {
 			const char ch = cb.CharAt(position);
 			if (ch == '\t') {
@@ -2283,6 +2447,74 @@ bool SplitMatch(const SplitView &view, size_t start, std::string_view text) noex
 	return true;
 }
 
+// Finds the next byte over the split view that may start a case-insensitive match:
+// one of 2 ASCII bytes or any byte from minHigh (0x80 or 0xC0 for UTF-8 lead bytes) up.
+// 8 bytes are examined at a time with bit operations and only blocks that may contain
+// a candidate are checked byte by byte.
+class SplitFindCandidate {
+	unsigned char ch1;
+	unsigned char ch2;
+	unsigned char minHigh;
+	uint64_t repeated1;
+	uint64_t repeated2;
+
+	static constexpr uint64_t lowBits = 0x0101010101010101ULL;
+	static constexpr uint64_t highBits = 0x8080808080808080ULL;
+
+	// Non-zero when any byte of value is 0
+	static constexpr uint64_t HasZeroByte(uint64_t value) noexcept {
+		return (value - lowBits) & ~value & highBits;
+	}
+
+	bool IsCandidate(unsigned char ch) const noexcept {
+		return ch == ch1 || ch == ch2 || ch >= minHigh;
+	}
+
+	const char *FindInSegment(const char *s, const char *end) const noexcept {
+		while (end - s >= 8) {
+			uint64_t block = 0;
+			memcpy(&block, s, sizeof(block));
+			uint64_t candidates = HasZeroByte(block ^ repeated1) | HasZeroByte(block ^ repeated2);
+			// Top bit set, and for lead bytes the next bit too
+			candidates |= (minHigh == 0x80) ? (block & highBits) : (block & (block << 1) & highBits);
+			if (candidates) {
+				break;
+			}
+			s += 8;
+		}
+		for (; s < end; s++) {
+			if (IsCandidate(*s)) {
+				return s;
+			}
+		}
+		return nullptr;
+	}
+
+public:
+	SplitFindCandidate(unsigned char ch1_, unsigned char ch2_, unsigned char minHigh_) noexcept :
+		ch1(ch1_), ch2(ch2_), minHigh(minHigh_), repeated1(lowBits * ch1_), repeated2(lowBits * ch2_) {
+		assert(minHigh == 0x80 || minHigh == 0xC0);
+	}
+
+	// Equivalent of SplitFindChar for the candidate bytes
+	ptrdiff_t Find(const SplitView &view, size_t start, size_t length) const noexcept {
+		size_t range1Length = 0;
+		if (start < view.length1) {
+			range1Length = std::min(length, view.length1 - start);
+			const char *match = FindInSegment(view.segment1 + start, view.segment1 + start + range1Length);
+			if (match) {
+				return match - view.segment1;
+			}
+			start += range1Length;
+		}
+		const char *match2 = FindInSegment(view.segment2 + start, view.segment2 + start + length - range1Length);
+		if (match2) {
+			return match2 - view.segment2;
+		}
+		return -1;
+	}
+};
+
 }
 
 /**
@@ -2371,7 +2603,20 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 			std::vector<char> searchThing((lengthFind+1) * UTF8MaxBytes * maxFoldingExpansion + 1);
 			const size_t lenSearch =
 				pcf->Fold(searchThing.data(), searchThing.size(), search, lengthFind);
+			// Forward searches skip to the bytes that may start a match: the ASCII bytes
+			// folding to the first byte of the search and the lead bytes of other characters.
+			std::optional<SplitFindCandidate> startFinder;
+			const unsigned char firstFolded = searchThing[0];
+			if (forward && !UTF8IsTrailByte(firstFolded)) {
+				startFinder.emplace(firstFolded, MakeUpperCase(firstFolded), 0xC0);
+			}
 			while (forward ? (pos < endPos) : (pos >= endPos)) {
+				if (startFinder) {
+					pos = startFinder->Find(cbView, pos, endPos - pos);
+					if (pos < 0) {
+						break;
+					}
+				}
 				int widthFirstCharacter = 1;
 				Sci::Position posIndexDocument = pos;
 				size_t indexSearch = 0;
@@ -2484,7 +2729,20 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 			const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
 			std::vector<char> searchThing(lengthFind + 1);
 			pcf->Fold(searchThing.data(), searchThing.size(), search, lengthFind);
+			// Forward searches skip to the bytes that may start a match: the ASCII bytes
+			// folding to the first byte of the search and all other bytes.
+			std::optional<SplitFindCandidate> startFinder;
+			if (forward) {
+				const unsigned char firstFolded = searchThing[0];
+				startFinder.emplace(firstFolded, MakeUpperCase(firstFolded), 0x80);
+			}
 			while (forward ? (pos < endSearch) : (pos >= endSearch)) {
+				if (startFinder) {
+					pos = startFinder->Find(cbView, pos, endSearch - pos);
+					if (pos < 0) {
+						break;
+					}
+				}
 				bool found = (pos + lengthFind) <= limitPos;
 				for (int indexSearch = 0; (indexSearch < lengthFind) && found; indexSearch++) {
 					const char ch = cbView.CharAt(pos + indexSearch);
@@ -2817,6 +3075,16 @@ void SCI_METHOD Document::DecorationFillRange(Sci_Position position, int value,
 	}
 }
 
+// Fills many (start, end) ranges sorted by start with a single modification notification.
+void Document::DecorationFillRanges(const Sci::Position *ranges, size_t rangeCount, int value) {
+	const FillResult<Sci::Position> fr = decorations->FillRanges(ranges, rangeCount, value);
+	if (fr.changed) {
+		const DocModification mh(ModificationFlags::ChangeIndicator | ModificationFlags::User,
+							fr.position, fr.fillLength);
+		NotifyModified(mh);
+	}
+}
+
 bool Document::AddWatcher(DocWatcher *watcher, void *userData) {
 	const WatcherWithUserData wwud(watcher, userData);
 	std::vector<WatcherWithUserData>::iterator it =
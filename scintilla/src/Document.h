@@ -17,6 +17,7 @@ class LineMarkers;
 class LineLevels;
 class LineState;
 class LineAnnotation;
+class ColumnCache;
 
 enum class EncodingFamily { eightBit, unicode, dbcs };
 
@@ -203,6 +204,20 @@ struct LexerReleaser {
 
 using LexerInstance = std::unique_ptr<Scintilla::ILexer5, LexerReleaser>;
 
+// Creates a lexer by name and returns it as an ILexer5 *, like Lexilla's CreateLexer.
+// Untyped so that it can be provided by C code.
+typedef void *(*LexerFactory)(const char *name);
+
+// A call made to configure the lexer instance, replayed on its clones for parallel lexing.
+struct LexerSetupStep {
+	enum class Kind { Property, WordList, AllocateSubStyles, SetIdentifiers, FreeSubStyles };
+	Kind kind;
+	int n;
+	int count;
+	std::string key;
+	std::string value;
+};
+
 // LexInterface defines the interface to ILexer used in Document.
 // The LexState subclass is actually created and that is used within ScintillaBase
 // to provide more methods that are exposed through Scintilla's external API.
@@ -211,6 +226,13 @@ protected:
 	Document *pdoc;
 	LexerInstance instance;
 	bool performingStyle;	///< Prevent reentrance
+	// Speculative parallel lexing, see ParallelLexing.cxx
+	LexerFactory lexerFactory;
+	unsigned int parallelThreads;
+	bool parallelBroken;	///< Lexer can't be cloned or doesn't lex chunks independently
+	std::vector<LexerSetupStep> setupSteps;
+	void RecordSetupStep(LexerSetupStep step);
+	bool ColouriseParallel(Sci::Position start, Sci::Position end, int styleStart);
 public:
 	explicit LexInterface(Document *pdoc_) noexcept;
 	// Deleted so LexInterface objects can not be copied.
@@ -220,6 +242,7 @@ public:
 	LexInterface &operator=(LexInterface &&) = delete;
 	virtual ~LexInterface() noexcept;
 	void SetInstance(ILexer5 *instance_) noexcept;
+	void SetParallelLexing(unsigned int threads, LexerFactory factory) noexcept;
 	void Colourise(Sci::Position start, Sci::Position end);
 	virtual Scintilla::LineEndType LineEndTypesSupported();
 	bool UseContainerLexing() const noexcept;
@@ -321,6 +344,7 @@ private:
 
 	std::unique_ptr<RegexSearchBase> regex;
 	std::unique_ptr<LexInterface> pli;
+	std::unique_ptr<ColumnCache> columnCache;
 
 	std::map<void *, ViewStateShared>viewData;
 
@@ -396,7 +420,7 @@ public:
 	EncodingFamily CodePageFamily() const noexcept;
 
 	// Gateways to modifying document
-	void ModifiedAt(Sci::Position pos) noexcept;
+	void ModifiedAt(Sci::Position pos);
 	void CheckReadOnly();
 	void TrimReplacement(std::string_view &text, Range &range) const noexcept;
 	bool DeleteChars(Sci::Position pos, Sci::Position len);
@@ -411,6 +435,7 @@ public:
 	bool CanUndo() const noexcept { return cb.CanUndo(); }
 	bool CanRedo() const noexcept { return cb.CanRedo(); }
 	void DeleteUndoHistory() noexcept { cb.DeleteUndoHistory(); }
+	void SetUndoMemoryLimit(size_t limit) noexcept { cb.SetUndoMemoryLimit(limit); }
 	bool SetUndoCollection(bool collectUndo) noexcept {
 		return cb.SetUndoCollection(collectUndo);
 	}
@@ -457,6 +482,7 @@ public:
 	Sci::Position SetLineIndentation(Sci::Line line, Sci::Position indent);
 	Sci::Position GetLineIndentPosition(Sci::Line line) const;
 	Sci::Position GetColumn(Sci::Position pos) const;
+	Sci::Position CharactersFromLineStart(Sci::Line line, Sci::Position pos) const;
 	Sci::Position CountCharacters(Sci::Position startPos, Sci::Position endPos) const noexcept;
 	Sci::Position CountUTF16(Sci::Position startPos, Sci::Position endPos) const noexcept;
 	Sci::Position FindColumn(Sci::Line line, Sci::Position column);
@@ -467,6 +493,7 @@ public:
 	void SetReadOnly(bool set) noexcept { cb.SetReadOnly(set); }
 	bool IsReadOnly() const noexcept { return cb.IsReadOnly(); }
 	bool IsLarge() const noexcept { return cb.IsLarge(); }
+	bool StylesAllocated() const noexcept { return cb.StylesAllocated(); }
 	Scintilla::DocumentOption Options() const noexcept;
 
 	void DelChar(Sci::Position pos);
@@ -552,6 +579,7 @@ public:
 	void IncrementStyleClock() noexcept;
 	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) override;
 	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override;
+	void DecorationFillRanges(const Sci::Position *ranges, size_t rangeCount, int value);
 	LexInterface *GetLexInterface() const noexcept;
 	void SetLexInterface(std::unique_ptr<LexInterface> pLexInterface) noexcept;
 
@@ -23,6 +23,7 @@
 #include <optional>
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <chrono>
 #include <atomic>
@@ -193,6 +194,7 @@ EditView::EditView() {
 	posCache = CreatePositionCache();
 	posCache->SetSize(0x400);
 	maxLayoutThreads = 1;
+	longLineLayoutLength = 0;
 	tabArrowHeight = 4;
 	customDrawTabArrow = nullptr;
 	customDrawWrapMarker = nullptr;
@@ -388,6 +390,86 @@ void LayoutSegments(IPositionCache *pCache,
 	}
 }
 
+// Long lines are measured in whole chunks of this many bytes around the left edge of the view.
+constexpr int longLineChunk = 4096;
+
+// Fill the positions of a long line after start from the character widths of the styles
+// instead of measuring the text, until end or until passing xLimit. Returns where it stopped.
+// This is exact for ASCII text in fonts found to be monospaced.
+int EstimatePositions(const EditView &view, const Document *pdoc, const ViewStyle &vstyle,
+	LineLayout *ll, Sci::Line line, int start, int end, XYPOSITION xLimit) {
+	const bool utf8 = CpUtf8 == pdoc->dbcsCodePage;
+	XYPOSITION x = ll->positions[start];
+	int i = start;
+	while ((i < end) && (x <= xLimit)) {
+		const unsigned char ch = ll->chars[i];
+		const Style &style = vstyle.styles[ll->styles[i]];
+		if (!style.visible) {
+			// Takes no space
+		} else if (ch == ' ') {
+			x += style.spaceWidth;
+		} else if ((ch > ' ') && (ch < 0x7f)) {
+			x += style.monospaceASCII ? style.monospaceCharacterWidth : style.aveCharWidth;
+		} else if (ch == '\t') {
+			x = view.NextTabstopPos(line, x, vstyle.tabWidth);
+		} else if (ch >= 0x80) {
+			int lenChar = 1;
+			if (utf8) {
+				lenChar = UTF8DrawBytes(&ll->chars[i], end - i);
+			} else if (pdoc->dbcsCodePage && pdoc->IsDBCSLeadByteNoExcept(ch) && (i + 1 < end)) {
+				lenChar = 2;
+			}
+			// Spread the width evenly over the bytes of the character like the platform layers do
+			const XYPOSITION xStart = x;
+			x += style.aveCharWidth;
+			for (int b = 1; b < lenChar; b++) {
+				ll->positions[i + b] = xStart + (x - xStart) * b / lenChar;
+			}
+			i += lenChar - 1;
+		} else {
+			x += style.aveCharWidth;
+		}
+		i++;
+		ll->positions[i] = x;
+	}
+	return i;
+}
+
+// Whether the positions of a long line with these styles can be estimated closely enough.
+// Other fonts vary too much around their average character width.
+bool StylesMonospaced(const ViewStyle &vstyle, const unsigned char *styles, int length) noexcept {
+	bool checked[256] {};
+	for (int i = 0; i < length; i++) {
+		const unsigned char styleIndex = styles[i];
+		if (!checked[styleIndex]) {
+			const Style &style = vstyle.styles[styleIndex];
+			if (style.visible && !style.monospaceASCII) {
+				return false;
+			}
+			checked[styleIndex] = true;
+		}
+	}
+	return true;
+}
+
+// The part of a long line to measure when the view starts at visibleStart: from the chunk
+// before the one containing it to the end of the one after it.
+Range LongLineMeasuredRange(const Document *pdoc, Sci::Position posLineStart, int visibleStart, int numCharsInLine) {
+	const int chunkStart = visibleStart - visibleStart % longLineChunk;
+	const Sci::Position start = std::max(chunkStart - longLineChunk, 0);
+	const Sci::Position end = std::min(chunkStart + 2 * longLineChunk, numCharsInLine);
+	return Range(pdoc->MovePositionOutsideChar(posLineStart + start, -1, false) - posLineStart,
+		pdoc->MovePositionOutsideChar(posLineStart + end, -1, false) - posLineStart);
+}
+
+// Whether the measured part of a long line still covers the view scrolled to xOffset, leaving
+// some slack so that small scrolls do not measure the line again.
+bool MeasuredAround(const LineLayout *ll, XYPOSITION xOffset) noexcept {
+	const int visibleStart = ll->FindBefore(xOffset, Range(0, ll->numCharsInLine));
+	return ((ll->measured.start == 0) || (visibleStart >= ll->measured.start + longLineChunk / 2)) &&
+		((ll->measured.end == ll->numCharsInLine) || (visibleStart + longLineChunk / 2 <= ll->measured.end));
+}
+
 }
 
 /**
@@ -410,6 +492,17 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 	// Hard to cope when too narrow, so just assume there is space
 	width = std::max(width, 20);
 
+	// Long lines that are not wrapped are only measured around the horizontally visible part,
+	// when their styles are monospaced as checked once they are copied below
+	bool longLine = (longLineLayoutLength > 0) && (width == LineLayout::wrapWidthInfinite) &&
+		((posLineEnd - posLineStart) >= longLineLayoutLength) && !model.BidirectionalEnabled();
+	if ((ll->validity != LineLayout::ValidLevel::invalid) && (ll->measured.Length() < ll->numCharsInLine)) {
+		// Comparing the whole line would cost about as much as measuring its visible part again
+		if (!longLine || (ll->validity == LineLayout::ValidLevel::checkTextAndStyle) || !MeasuredAround(ll, model.xOffset)) {
+			ll->validity = LineLayout::ValidLevel::invalid;
+		}
+	}
+
 	if (ll->validity == LineLayout::ValidLevel::checkTextAndStyle) {
 		Sci::Position lineLength = posLineEnd - posLineStart;
 		if (!vstyle.viewEOL) {
@@ -479,17 +572,28 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 		ll->positions[0] = 0;
 		bool lastSegItalics = false;
 
+		// Only the measured range of a long line is measured, the rest is estimated.
+		Range measured(0, numCharsInLine);
+		longLine = longLine && StylesMonospaced(vstyle, ll->styles.get(), numCharsInLine);
+		if (longLine) {
+			const int visibleStart = EstimatePositions(*this, model.pdoc, vstyle, ll, line,
+				0, numCharsInLine, model.xOffset);
+			measured = LongLineMeasuredRange(model.pdoc, posLineStart, visibleStart, numCharsInLine);
+		}
+
 		std::vector<TextSegment> segments;
-		BreakFinder bfLayout(ll, nullptr, Range(0, numCharsInLine), posLineStart, 0, BreakFinder::BreakFor::Text, model.pdoc, model.reprs.get(), nullptr);
+		BreakFinder bfLayout(ll, nullptr, measured, posLineStart, 0, BreakFinder::BreakFor::Text, model.pdoc, model.reprs.get(), nullptr);
 		while (bfLayout.More()) {
 			segments.push_back(bfLayout.Next());
 		}
 
-		ll->ClearPositions();
+		if (!longLine) {
+			ll->ClearPositions();
+		}
 
 		if (!segments.empty()) {
 
-			const size_t threadsForLength = std::max(1, numCharsInLine / bytesPerLayoutThread);
+			const size_t threadsForLength = std::max<Sci::Position>(1, measured.Length() / bytesPerLayoutThread);
 			size_t threads = std::min<size_t>({ segments.size(), threadsForLength, maxLayoutThreads });
 			if (!surface->SupportsFeature(Supports::ThreadSafeMeasureWidths) || callerMultiThreaded) {
 				threads = 1;
@@ -520,8 +624,8 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 		}
 
 		// Accumulate absolute positions from relative positions within segments and expand tabs
-		XYPOSITION xPosition = 0.0;
-		size_t iByte = 0;
+		XYPOSITION xPosition = ll->positions[measured.start];
+		size_t iByte = measured.start;
 		ll->positions[iByte++] = xPosition;
 		for (const TextSegment &ts : segments) {
 			if (vstyle.styles[ll->styles[ts.start]].visible &&
@@ -539,7 +643,12 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 			}
 		}
 
-		if (!segments.empty()) {
+		if (measured.end < numCharsInLine) {
+			EstimatePositions(*this, model.pdoc, vstyle, ll, line, static_cast<int>(measured.end),
+				numCharsInLine, std::numeric_limits<XYPOSITION>::max());
+		}
+
+		if (!segments.empty() && (segments.back().end() == numCharsInLine)) {
 			// Not quite the same as before which would effectively ignore trailing invisible segments
 			const TextSegment &ts = segments.back();
 			lastSegItalics = (!ts.representation) && ((ll->chars[ts.end() - 1] != ' ') && vstyle.styles[ll->styles[ts.start]].italic);
@@ -551,6 +660,7 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 		}
 		ll->numCharsInLine = numCharsInLine;
 		ll->numCharsBeforeEOL = numCharsBeforeEOL;
+		ll->measured = measured;
 		ll->validity = LineLayout::ValidLevel::positions;
 	}
 	if ((ll->validity == LineLayout::ValidLevel::positions) || (ll->widthLine != width)) {
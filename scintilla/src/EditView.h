@@ -84,6 +84,10 @@ public:
 	unsigned int maxLayoutThreads;
 	static constexpr int bytesPerLayoutThread = 1000;
 
+	/// Lines at least this long are, when not wrapped, only measured around the
+	/// horizontally visible part. 0 measures all lines completely.
+	Sci::Position longLineLayoutLength;
+
 	int tabArrowHeight; // draw arrow heads this many pixels above/below line midpoint
 	/** Some platforms, notably PLAT_CURSES, do not support Scintilla's native
 	 * DrawTabArrow function for drawing tab characters. Allow those platforms to
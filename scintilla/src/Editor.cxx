@@ -66,6 +66,7 @@
 #include "EditModel.h"
 #include "MarginView.h"
 #include "EditView.h"
+#include "BackgroundWrap.h"
 #include "Editor.h"
 #include "ElapsedPeriod.h"
 
@@ -230,6 +231,9 @@ void Editor::DropGraphics() noexcept {
 void Editor::InvalidateStyleData() noexcept {
 	stylesValid = false;
 	vs.technology = technology;
+	if (backgroundWrap) {
+		backgroundWrap->InvalidateStyle();
+	}
 	DropGraphics();
 	view.llc.Invalidate(LineLayout::ValidLevel::invalid);
 	view.posCache->Clear();
@@ -241,6 +245,26 @@ void Editor::InvalidateStyleRedraw() {
 	Redraw();
 }
 
+void Editor::SetLongLineLayoutLength(Sci::Position length) {
+	if (view.longLineLayoutLength != length) {
+		view.longLineLayoutLength = length;
+		InvalidateStyleRedraw();
+	}
+}
+
+void Editor::SetBackgroundWrap(bool on) {
+	if (on && !backgroundWrap) {
+		backgroundWrap = std::make_unique<BackgroundWrap>();
+	} else if (!on && backgroundWrap) {
+		backgroundWrap.reset();
+		FineTickerCancel(TickReason::wrap);
+		// Carry on wrapping on this thread
+		if (Wrapping() && wrapPending.NeedsWrap()) {
+			SetIdle(true);
+		}
+	}
+}
+
 void Editor::RefreshStyleData() {
 	if (!stylesValid) {
 		stylesValid = true;
@@ -1504,6 +1528,9 @@ bool Editor::Wrapping() const noexcept {
 
 void Editor::NeedWrapping(Sci::Line docLineStart, Sci::Line docLineEnd) {
 //Platform::DebugPrintf("\nNeedWrapping: %0d..%0d\n", docLineStart, docLineEnd);
+	if (backgroundWrap) {
+		backgroundWrap->Cancel(docLineStart);
+	}
 	if (wrapPending.AddRange(docLineStart, docLineEnd)) {
 		view.llc.Invalidate(LineLayout::ValidLevel::positions);
 	}
@@ -1650,10 +1677,94 @@ bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToW
 	return wrapsDone > 0;
 }
 
+bool Editor::WrappingInBackground() const {
+	return backgroundWrap && backgroundWrap->Running();
+}
+
+// Start wrapping a block of lines from lineToWrap on layout threads unless one is pending.
+// Returns false when the lines can not be wrapped there and should be wrapped here.
+bool Editor::StartBackgroundWrap(Sci::Line lineToWrap, Sci::Line lineEndNeedWrap) {
+	if (backgroundWrap->Pending()) {
+		// Committed by a later idle call
+		return true;
+	}
+	// Custom tab stops are not copied to the block, nor are lexer line ends
+	if ((lineToWrap >= lineEndNeedWrap) || view.ldTabstops ||
+		(pdoc->GetLineEndTypesAllowed() != LineEndType::Default)) {
+		return false;
+	}
+
+	PRectangle rcTextArea = GetClientRectangle();
+	rcTextArea.left = static_cast<XYPOSITION>(vs.textStart);
+	rcTextArea.right -= vs.rightMarginWidth;
+	wrapWidth = static_cast<int>(rcTextArea.Width());
+	RefreshStyleData();
+	if (!backgroundWrap->StyleValid()) {
+		std::unique_ptr<Surface> surface = CreateMeasurementSurface();
+		if (!surface || !surface->SupportsFeature(Supports::ThreadSafeMeasureWidths)) {
+			return false;
+		}
+		backgroundWrap->SetStyle(std::move(surface), vs, pdoc->tabInChars);
+	}
+
+	// Blocks take about a tenth of a second so few lines are wrapped again when one is
+	// cancelled while starting threads stays cheap.
+	const unsigned int threads = std::max(view.maxLayoutThreads, 1U);
+	constexpr double secondsAllowed = 0.1;
+	const size_t actionsInAllowedTime = std::clamp<size_t>(
+		durationWrapOneByte.ActionsInAllowedTime(secondsAllowed * threads),
+		0x10000, 0x1000000);
+	Sci::Line lineToWrapEnd = std::min(pdoc->LineFromPositionAfter(lineToWrap, actionsInAllowedTime), lineEndNeedWrap);
+
+	// Styling stays on this thread so only style as much at once as idle styling does.
+	const Sci::Line lineEndStyled = pdoc->SciLineFromPosition(pdoc->GetEndStyled());
+	if (lineToWrapEnd > lineEndStyled) {
+		const size_t actionsToStyle = std::clamp<size_t>(
+			pdoc->durationStyleOneByte.ActionsInAllowedTime(0.02),
+			0x200, 0x20000);
+		lineToWrapEnd = std::min(lineToWrapEnd,
+			pdoc->LineFromPositionAfter(std::max(lineEndStyled, lineToWrap), actionsToStyle));
+	}
+	pdoc->EnsureStyledTo(pdoc->LineStart(lineToWrapEnd));
+
+	backgroundWrap->Start(*this, lineToWrap, lineToWrapEnd, wrapWidth, threads);
+	// Polls for the block to be finished, as the threads can not wake this one
+	FineTickerStart(TickReason::wrap, 10, 5);
+	return true;
+}
+
+// Set the heights of the lines of the block wrapped on layout threads, if it is finished or
+// once it is when wait is true. Return true if any height changed.
+bool Editor::CommitBackgroundWrap(bool wait) {
+	const std::optional<BackgroundWrap::Result> result = backgroundWrap->Collect(wait);
+	if (!result || (result->width != wrapWidth)) {
+		return false;
+	}
+
+	const Sci::Line linesWrapped = std::min<Sci::Line>(result->linesAfterWrap.size(),
+		pdoc->LinesTotal() - result->lineStart);
+	size_t wrapsDone = 0;
+	for (Sci::Line i = 0; i < linesWrapped; i++) {
+		const Sci::Line lineNumber = result->lineStart + i;
+		int linesAfterWrap = result->linesAfterWrap[i];
+		if (vs.annotationVisible != AnnotationVisible::Hidden) {
+			linesAfterWrap += pdoc->AnnotationLines(lineNumber);
+		}
+		if (pcs->SetHeight(lineNumber, linesAfterWrap)) {
+			wrapsDone++;
+		}
+		wrapPending.Wrapped(lineNumber);
+	}
+
+	durationWrapOneByte.AddSample(result->bytes, result->duration);
+
+	return wrapsDone > 0;
+}
+
 // Perform  wrapping for a subset of the lines needing wrapping.
 // wsAll: wrap all lines which need wrapping in this single call
 // wsVisible: wrap currently visible lines
-// wsIdle: wrap one page + 100 lines
+// wsIdle: wrap one page + 100 lines, or a block on layout threads when backgroundWrap is set
 // Return true if wrapping occurred.
 bool Editor::WrapLines(WrapScope ws) {
 	Sci::Line goodTopLine = topLine;
@@ -1690,7 +1801,20 @@ bool Editor::WrapLines(WrapScope ws) {
 			const Sci::Line subLineTop = topLine - pcs->DisplayFromDoc(lineDocTop);
 			lineScrollTo = { lineDocTop, subLineTop };
 		}
-		if (ws == WrapScope::wsVisible) {
+		bool wrappingInBackground = false;
+		if (backgroundWrap && (ws != WrapScope::wsVisible)) {
+			// Lines wrapped on layout threads, waited for when all lines are needed now
+			if (CommitBackgroundWrap(ws == WrapScope::wsAll)) {
+				wrapOccurred = true;
+				goodTopLine = pcs->DisplayFromDocSub(lineScrollTo.lineDoc, lineScrollTo.subLine);
+			}
+			lineToWrap = std::min(wrapPending.start, pdoc->LinesTotal());
+			wrappingInBackground = (ws == WrapScope::wsIdle) && StartBackgroundWrap(lineToWrap, lineToWrapEnd);
+		}
+		if (wrappingInBackground) {
+			// No lines to wrap on this thread
+			lineToWrapEnd = lineToWrap;
+		} else if (ws == WrapScope::wsVisible) {
 			lineToWrap = std::clamp(lineDocTop-5, wrapPending.start, pdoc->LinesTotal());
 			// Priority wrap to just after visible area.
 			// Since wrapping could reduce display lines, treat each
@@ -5248,13 +5372,14 @@ void Editor::ButtonUpWithModifiers(Point pt, unsigned int curTime, KeyMod modifi
 bool Editor::Idle() {
 	NotifyUpdateUI();
 
-	bool needWrap = Wrapping() && wrapPending.NeedsWrap();
+	// Lines being wrapped on layout threads are committed once the wrap ticker sees them done
+	bool needWrap = Wrapping() && wrapPending.NeedsWrap() && !WrappingInBackground();
 
 	if (needWrap) {
 		// Wrap lines during idle.
 		WrapLines(WrapScope::wsIdle);
-		// No more wrapping
-		needWrap = wrapPending.NeedsWrap();
+		// No more wrapping, or waiting for layout threads
+		needWrap = wrapPending.NeedsWrap() && !WrappingInBackground();
 	} else if (needIdleStyling) {
 		IdleStyle();
 	}
@@ -5298,6 +5423,18 @@ void Editor::TickFor(TickReason reason) {
 			}
 			FineTickerCancel(TickReason::dwell);
 			break;
+		case TickReason::wrap:
+			if (!WrappingInBackground()) {
+				FineTickerCancel(TickReason::wrap);
+				if (Wrapping() && wrapPending.NeedsWrap()) {
+					// Commit the finished block and start the next one
+					SetIdle(true);
+				} else if (backgroundWrap) {
+					// Already wrapped on this thread
+					backgroundWrap->Cancel();
+				}
+			}
+			break;
 		default:
 			// tickPlatform handled by subclass
 			break;
@@ -5696,12 +5833,20 @@ void Editor::FoldExpand(Sci::Line line, FoldAction action, FoldLevel level) {
 	const Sci::Line lineMaxSubord = pdoc->GetLastChild(line, LevelNumberPart(level));
 	line++;
 	pcs->SetVisible(line, lineMaxSubord, expanding);
-	while (line <= lineMaxSubord) {
-		const FoldLevel levelLine = pdoc->GetFoldLevel(line);
-		if (LevelIsHeader(levelLine)) {
-			SetFoldExpanded(line, expanding);
+	bool changed = false;
+	if (expanding) {
+		// Lines that are not fold headers are always expanded so expand the whole range
+		changed = pcs->ExpandRange(line, lineMaxSubord);
+	} else {
+		for (; line <= lineMaxSubord; line++) {
+			const FoldLevel levelLine = pdoc->GetFoldLevel(line);
+			if (LevelIsHeader(levelLine)) {
+				changed = pcs->SetExpanded(line, false) || changed;
+			}
 		}
-		line++;
+	}
+	if (changed) {
+		RedrawSelMargin();
 	}
 	SetScrollBars();
 	Redraw();
@@ -5800,20 +5945,25 @@ void Editor::FoldAll(FoldAction action) {
 		pcs->SetVisible(0, maxLine-1, true);
 		pcs->ExpandAll();
 	} else {
+		// When contracting every level, also hide the children of headers above the
+		// base level that are not inside another header, like the first lines of an
+		// indented file, so no contracted header is left with visible children.
+		Sci::Line lineHiddenEnd = -1;
 		for (; line < maxLine; line++) {
 			const FoldLevel level = pdoc->GetFoldLevel(line);
 			if (LevelIsHeader(level)) {
-				if (FoldLevel::Base == LevelNumberPart(level)) {
-					SetFoldExpanded(line, false);
+				if (FoldLevel::Base == LevelNumberPart(level) || (contractAll && line > lineHiddenEnd)) {
+					pcs->SetExpanded(line, false);
 					const Sci::Line lineMaxSubord = pdoc->GetLastChild(line);
 					if (lineMaxSubord > line) {
 						pcs->SetVisible(line + 1, lineMaxSubord, false);
+						lineHiddenEnd = std::max(lineHiddenEnd, lineMaxSubord);
 						if (!contractAll) {
 							line = lineMaxSubord;
 						}
 					}
 				} else if (contractAll) {
-					SetFoldExpanded(line, false);
+					pcs->SetExpanded(line, false);
 				}
 			}
 		}
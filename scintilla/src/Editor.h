@@ -10,6 +10,8 @@
 
 namespace Scintilla::Internal {
 
+class BackgroundWrap;
+
 /**
  */
 class Timer {
@@ -283,6 +285,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	// Wrapping support
 	WrapPending wrapPending;
 	ActionDuration durationWrapOneByte;
+	std::unique_ptr<BackgroundWrap> backgroundWrap;	// Set to wrap lines in idle time on layout threads
 	bool insideWrapScroll;
 	struct LineDocSub {
 		Scintilla::Line lineDoc = 0;
@@ -412,6 +415,9 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void NeedWrapping(Sci::Line docLineStart=0, Sci::Line docLineEnd=WrapPending::lineLarge);
 	bool WrapOneLine(Surface *surface, Sci::Line lineToWrap);
 	bool WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd);
+	bool WrappingInBackground() const;
+	bool StartBackgroundWrap(Sci::Line lineToWrap, Sci::Line lineEndNeedWrap);
+	bool CommitBackgroundWrap(bool wait);
 	enum class WrapScope {wsAll, wsVisible, wsIdle};
 	bool WrapLines(WrapScope ws);
 	void LinesJoin();
@@ -559,7 +565,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void ButtonUpWithModifiers(Point pt, unsigned int curTime, Scintilla::KeyMod modifiers);
 
 	bool Idle();
-	enum class TickReason { caret, scroll, widen, dwell, platform };
+	enum class TickReason { caret, scroll, widen, dwell, wrap, platform };
 	virtual void TickFor(TickReason reason);
 	virtual bool FineTickerRunning(TickReason reason);
 	virtual void FineTickerStart(TickReason reason, int millis, int tolerance);
@@ -709,6 +715,10 @@ public:
 	virtual Scintilla::sptr_t WndProc(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam);
 	// Public so scintilla_set_id can use it.
 	int ctrlID;
+	// Public so scintilla_set_long_line_layout_length can use it.
+	void SetLongLineLayoutLength(Sci::Position length);
+	// Public so scintilla_set_background_wrap can use it.
+	void SetBackgroundWrap(bool on);
 	// Public so COM methods for drag and drop can set it.
 	Scintilla::Status errorStatus;
 	friend class AutoSurface;
@@ -0,0 +1,404 @@
+// Scintilla source code edit control
+/** @file ParallelLexing.cxx
+ ** Speculative parallel lexing of independent document chunks.
+ **
+ ** The range to lex is split at line starts into one chunk per thread. Each chunk is lexed by
+ ** a clone of the document's lexer into a scratch style buffer, assuming the lexer starts the
+ ** chunk in its default state (style 0, line state 0 and base fold level before it). The
+ ** chunks are then committed in order: a chunk is kept when everything its lexer read from
+ ** before the chunk, and the line state of its first line, agree with the real document after
+ ** committing the previous chunk. On the first disagreement, the rest of the range is lexed
+ ** sequentially on the real document. The first chunk starts from the real state and is kept.
+ **
+ ** This only suits lexers keeping all their state in the document's styles and line states,
+ ** the caller is responsible for only enabling it for those. Chunks whose lexer sets fold
+ ** levels or indicators are never kept: folding stays sequential.
+ **/
+// Copyright 2026 by The Geany contributors
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <map>
+#include <forward_list>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <future>
+
+#include "ScintillaTypes.h"
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+// Smallest chunk worth a thread
+constexpr Sci::Position minChunkLength = 256 * 1024;
+
+constexpr int levelUnset = -1;
+
+// The view of the document given to a lexer clone: text and line structure come from the
+// real document, which is not modified while the clones run, styles, line states and fold
+// levels of the chunk go to scratch buffers.
+class ChunkDocument : public IDocument {
+	Document *pdoc;
+	const char *text;
+	bool realBefore;	// Whether the state before the chunk is the real one
+	Sci::Position endStyled;
+	std::vector<char> styles;
+	std::vector<int> lineStates;
+	std::vector<bool> lineStateSet;
+	std::vector<int> levels;
+	std::optional<int> nextLineState;	// For the first line of the next chunk
+	// What the lexer read of the state before the chunk, which was assumed rather than real
+	mutable Sci::Position assumedStylesFrom;	// Styles from there to start were read as 0
+	mutable Sci::Line assumedLineStatesFrom;	// Line states from there to lineStart were read as 0
+	mutable Sci::Line assumedLevelsFrom;	// Levels from there to lineStart were read as base
+	// The line state of the first line as read from the document, which the previous chunk may change
+	mutable std::optional<int> firstLineStateRead;
+
+	bool InChunk(Sci_Position position) const noexcept {
+		return position >= start && position < end;
+	}
+	bool InChunkLines(Sci_Position line) const noexcept {
+		return line >= lineStart && line <= lineLast;
+	}
+
+public:
+	const Sci::Position start;
+	const Sci::Position end;
+	const Sci::Line lineStart;
+	const Sci::Line lineLast;
+	bool failed;	// Did something that can't be replayed on the real document
+	bool setLevels;
+
+	ChunkDocument(Document *pdoc_, const char *text_, Sci::Position start_, Sci::Position end_, bool realBefore_) :
+		pdoc(pdoc_), text(text_), realBefore(realBefore_), endStyled(start_),
+		start(start_), end(end_),
+		lineStart(pdoc_->SciLineFromPosition(start_)), lineLast(pdoc_->SciLineFromPosition(end_ - 1)),
+		failed(false), setLevels(false) {
+		// Starting in the default style assumes the one before the chunk, and its line state
+		assumedStylesFrom = start - 1;
+		assumedLineStatesFrom = lineStart - 1;
+		assumedLevelsFrom = lineStart;
+	}
+
+	// Separate from the constructor so that it runs on the worker thread
+	void Prepare() {
+		const size_t lines = lineLast - lineStart + 1;
+		styles.resize(end - start);
+		pdoc->GetStyleRange(reinterpret_cast<unsigned char *>(styles.data()), start, end - start);
+		lineStates.resize(lines);
+		lineStateSet.resize(lines);
+		levels.assign(lines, levelUnset);
+	}
+
+	bool Complete() const noexcept {
+		return !failed && endStyled >= end;
+	}
+
+	// Whether the state the lexer assumed before the chunk is the one of target, once the
+	// previous chunks are committed to it
+	bool AgreesWith(const Document *target) const {
+		if (realBefore) {
+			return true;
+		}
+		// Levels depend on the previous chunk
+		if (setLevels) {
+			return false;
+		}
+		for (Sci::Position position = assumedStylesFrom; position < start; position++) {
+			if (target->StyleAt(position) != 0)
+				return false;
+		}
+		for (Sci::Line line = assumedLineStatesFrom; line < lineStart; line++) {
+			if (target->GetLineState(line) != 0)
+				return false;
+		}
+		for (Sci::Line line = assumedLevelsFrom; line < lineStart; line++) {
+			if (target->GetLevel(line) != static_cast<int>(FoldLevel::Base))
+				return false;
+		}
+		return !firstLineStateRead || (target->GetLineState(lineStart) == *firstLineStateRead);
+	}
+
+	void CommitTo(Document *target) {
+		target->StartStyling(start);
+		target->SetStyles(end - start, styles.data());
+		for (Sci::Line line = lineStart; line <= lineLast; line++) {
+			const size_t i = line - lineStart;
+			if (lineStateSet[i])
+				target->SetLineState(line, lineStates[i]);
+			if (levels[i] != levelUnset)
+				target->SetLevel(line, levels[i]);
+		}
+		if (nextLineState)
+			target->SetLineState(lineLast + 1, *nextLineState);
+	}
+
+	int SCI_METHOD Version() const override {
+		return Scintilla::dvRelease4;
+	}
+	void SCI_METHOD SetErrorStatus(int) override {
+		failed = true;
+	}
+	Sci_Position SCI_METHOD Length() const override {
+		return pdoc->Length();
+	}
+	void SCI_METHOD GetCharRange(char *buffer, Sci_Position position, Sci_Position lengthRetrieve) const override {
+		pdoc->GetCharRange(buffer, position, lengthRetrieve);
+	}
+	char SCI_METHOD StyleAt(Sci_Position position) const override {
+		if (InChunk(position))
+			return styles[position - start];
+		if (position < start && !realBefore) {
+			assumedStylesFrom = std::min<Sci::Position>(assumedStylesFrom, position);
+			return 0;	// Assumed default state
+		}
+		return pdoc->StyleAt(position);
+	}
+	Sci_Position SCI_METHOD LineFromPosition(Sci_Position position) const override {
+		return pdoc->LineFromPosition(position);
+	}
+	Sci_Position SCI_METHOD LineStart(Sci_Position line) const override {
+		return pdoc->LineStart(line);
+	}
+	int SCI_METHOD GetLevel(Sci_Position line) const override {
+		if (InChunkLines(line) && levels[line - lineStart] != levelUnset)
+			return levels[line - lineStart];
+		if (line < lineStart && !realBefore) {
+			assumedLevelsFrom = std::min<Sci::Line>(assumedLevelsFrom, line);
+			return static_cast<int>(FoldLevel::Base);
+		}
+		return pdoc->GetLevel(line);
+	}
+	int SCI_METHOD SetLevel(Sci_Position line, int level) override {
+		const int prev = GetLevel(line);
+		if (InChunkLines(line)) {
+			levels[line - lineStart] = level;
+			setLevels = true;
+		} else {
+			failed = true;
+		}
+		return prev;
+	}
+	int SCI_METHOD GetLineState(Sci_Position line) const override {
+		if (InChunkLines(line) && lineStateSet[line - lineStart])
+			return lineStates[line - lineStart];
+		if (line == lineLast + 1 && nextLineState)
+			return *nextLineState;
+		if (line < lineStart && !realBefore) {
+			assumedLineStatesFrom = std::min<Sci::Line>(assumedLineStatesFrom, line);
+			return 0;
+		}
+		const int state = pdoc->GetLineState(line);
+		if (line == lineStart && !firstLineStateRead)
+			firstLineStateRead = state;
+		return state;
+	}
+	int SCI_METHOD SetLineState(Sci_Position line, int state) override {
+		const int prev = GetLineState(line);
+		if (InChunkLines(line)) {
+			lineStates[line - lineStart] = state;
+			lineStateSet[line - lineStart] = true;
+		} else if (line == lineLast + 1) {
+			nextLineState = state;
+		} else if (line > lineLast) {
+			failed = true;
+		}
+		// Changes before the chunk come from lexers backing up to a safe position and
+		// are redone by the previous chunk
+		return prev;
+	}
+	void SCI_METHOD StartStyling(Sci_Position position) override {
+		endStyled = position;
+	}
+	bool SCI_METHOD SetStyleFor(Sci_Position length, char style) override {
+		for (Sci_Position i = 0; i < length; i++, endStyled++) {
+			if (InChunk(endStyled))
+				styles[endStyled - start] = style;
+		}
+		return true;
+	}
+	bool SCI_METHOD SetStyles(Sci_Position length, const char *styles_) override {
+		for (Sci_Position i = 0; i < length; i++, endStyled++) {
+			if (InChunk(endStyled))
+				styles[endStyled - start] = styles_[i];
+		}
+		return true;
+	}
+	void SCI_METHOD DecorationSetCurrentIndicator(int) override {
+		failed = true;
+	}
+	void SCI_METHOD DecorationFillRange(Sci_Position, int, Sci_Position) override {
+		failed = true;
+	}
+	void SCI_METHOD ChangeLexerState(Sci_Position, Sci_Position) override {
+		failed = true;
+	}
+	int SCI_METHOD CodePage() const override {
+		return pdoc->CodePage();
+	}
+	bool SCI_METHOD IsDBCSLeadByte(char ch) const override {
+		return pdoc->IsDBCSLeadByte(ch);
+	}
+	const char * SCI_METHOD BufferPointer() override {
+		return text;
+	}
+	int SCI_METHOD GetLineIndentation(Sci_Position line) override {
+		return pdoc->GetLineIndentation(line);
+	}
+	Sci_Position SCI_METHOD LineEnd(Sci_Position line) const override {
+		return pdoc->LineEnd(line);
+	}
+	Sci_Position SCI_METHOD GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const override {
+		return pdoc->GetRelativePosition(positionStart, characterOffset);
+	}
+	int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const override {
+		return pdoc->GetCharacterAndWidth(position, pWidth);
+	}
+};
+
+void ApplySetupStep(ILexer5 *lexer, const LexerSetupStep &step) {
+	switch (step.kind) {
+	case LexerSetupStep::Kind::Property:
+		lexer->PropertySet(step.key.c_str(), step.value.c_str());
+		break;
+	case LexerSetupStep::Kind::WordList:
+		lexer->WordListSet(step.n, step.value.c_str());
+		break;
+	case LexerSetupStep::Kind::AllocateSubStyles:
+		lexer->AllocateSubStyles(step.n, step.count);
+		break;
+	case LexerSetupStep::Kind::SetIdentifiers:
+		lexer->SetIdentifiers(step.n, step.value.c_str());
+		break;
+	case LexerSetupStep::Kind::FreeSubStyles:
+		lexer->FreeSubStyles();
+		break;
+	}
+}
+
+}
+
+void LexInterface::RecordSetupStep(LexerSetupStep step) {
+	// Only the last value of a property or word list matters
+	if (step.kind == LexerSetupStep::Kind::Property || step.kind == LexerSetupStep::Kind::WordList) {
+		for (LexerSetupStep &previous : setupSteps) {
+			if (previous.kind == step.kind && previous.n == step.n && previous.key == step.key) {
+				previous.value = std::move(step.value);
+				return;
+			}
+		}
+	}
+	setupSteps.push_back(std::move(step));
+}
+
+bool LexInterface::ColouriseParallel(Sci::Position start, Sci::Position end, int styleStart) {
+	if (parallelThreads < 2 || !lexerFactory || parallelBroken)
+		return false;
+
+	const Sci::Position length = end - start;
+	const Sci::Position chunks = std::min<Sci::Position>(parallelThreads, length / minChunkLength);
+	if (chunks < 2)
+		return false;
+
+	std::vector<Sci::Position> bounds { start };
+	for (Sci::Position i = 1; i < chunks; i++) {
+		const Sci::Position bound = pdoc->LineStart(pdoc->SciLineFromPosition(start + length * i / chunks) + 1);
+		if (bound > bounds.back() && bound < end)
+			bounds.push_back(bound);
+	}
+	bounds.push_back(end);
+	if (bounds.size() < 3)
+		return false;
+
+	std::vector<LexerInstance> clones;
+	try {
+		for (size_t i = 0; i + 1 < bounds.size(); i++) {
+			clones.emplace_back(static_cast<ILexer5 *>(lexerFactory(instance->GetName())));
+			if (!clones.back()) {
+				parallelBroken = true;
+				return false;
+			}
+			for (const LexerSetupStep &step : setupSteps)
+				ApplySetupStep(clones.back().get(), step);
+		}
+	} catch (...) {
+		parallelBroken = true;
+		return false;
+	}
+
+	// May move the gap, so not to be done by the clones
+	const char *text = pdoc->BufferPointer();
+	// Reading line states grows their storage up to the line read, so make it cover every line
+	// before the clones only read it
+	pdoc->GetLineState(pdoc->LinesTotal());
+	std::vector<std::unique_ptr<ChunkDocument>> chunkDocs;
+	for (size_t i = 0; i < clones.size(); i++)
+		chunkDocs.push_back(std::make_unique<ChunkDocument>(pdoc, text, bounds[i], bounds[i + 1], i == 0));
+
+	std::vector<std::future<void>> futures;
+	for (size_t i = 0; i < clones.size(); i++) {
+		ILexer5 *lexer = clones[i].get();
+		ChunkDocument *chunk = chunkDocs[i].get();
+		const int initStyle = (i == 0) ? styleStart : 0;
+		futures.push_back(std::async(std::launch::async, [lexer, chunk, initStyle]() {
+			try {
+				chunk->Prepare();
+				lexer->Lex(chunk->start, chunk->end - chunk->start, initStyle, chunk);
+			} catch (...) {
+				chunk->failed = true;
+			}
+		}));
+	}
+	for (std::future<void> &f : futures)
+		f.wait();
+
+	for (size_t i = 0; i < chunkDocs.size(); i++) {
+		ChunkDocument &chunk = *chunkDocs[i];
+		if (chunk.Complete() && chunk.AgreesWith(pdoc)) {
+			chunk.CommitTo(pdoc);
+		} else {
+			// Lexers setting fold levels while lexing can't use chunks as levels depend on
+			// the previous chunk
+			if (chunk.setLevels)
+				parallelBroken = true;
+			// The state reached at the end of this chunk may differ from what the following
+			// chunks assumed too, so don't trust them either
+			const int initStyle = (i == 0) ? styleStart : pdoc->StyleAt(chunk.start - 1);
+			instance->Lex(chunk.start, end - chunk.start, initStyle, pdoc);
+			break;
+		}
+	}
+	return true;
+}
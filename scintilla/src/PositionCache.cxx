@@ -839,10 +839,19 @@ BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lin
 	// First find the first visible character
 	if (xStart > 0.0f)
 		nextBreak = ll->FindBefore(xStart, lineRange);
-	// Now back to a style break
-	while ((nextBreak > lineRange.start) && (ll->styles[nextBreak] == ll->styles[nextBreak - 1])) {
+	// Now back to a style break, but not too far in a long line only measured around its
+	// visible part as it may be a single style
+	const bool longLine = ll->measured.Length() < ll->numCharsInLine;
+	const int backLimit = longLine ?
+		std::max(static_cast<int>(lineRange.start), nextBreak - lengthBackToStyleBreak) :
+		static_cast<int>(lineRange.start);
+	while ((nextBreak > backLimit) && (ll->styles[nextBreak] == ll->styles[nextBreak - 1])) {
 		nextBreak--;
 	}
+	if (longLine && (nextBreak == backLimit)) {
+		// Start on a character
+		nextBreak = static_cast<int>(pdoc->MovePositionOutsideChar(posLineStart + nextBreak, -1, false) - posLineStart);
+	}
 
 	if (FlagSet(breakFor, BreakFor::Selection)) {
 		const SelectionSegment segmentLine(posLineStart, posLineStart + lineRange.end);
@@ -872,7 +881,7 @@ BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lin
 	if (FlagSet(breakFor, BreakFor::Foreground) && pvsDraw->indicatorsSetFore) {
 		for (const IDecoration *deco : pdoc->decorations->View()) {
 			if (pvsDraw->indicators[deco->Indicator()].OverridesTextFore()) {
-				Sci::Position startPos = deco->EndRun(posLineStart);
+				Sci::Position startPos = deco->EndRun(posLineStart + nextBreak);
 				while (startPos < (posLineStart + lineRange.end)) {
 					Insert(startPos - posLineStart);
 					startPos = deco->EndRun(startPos);
@@ -972,8 +981,10 @@ bool BreakFinder::More() const noexcept {
 	return (subBreak >= 0) || (nextBreak < lineRange.end);
 }
 
+// Entries are keyed by font rather than style so that the many styles sharing a font,
+// differing only in colour, share measurements.
 class PositionCacheEntry {
-	uint16_t styleNumber = 0;
+	const Font *font = nullptr;
 	uint16_t len = 0;
 	uint16_t clock = 0;
 	bool unicode = false;
@@ -987,10 +998,10 @@ public:
 	void operator=(const PositionCacheEntry &) = delete;
 	void operator=(PositionCacheEntry &&) = delete;
 	~PositionCacheEntry();
-	void Set(unsigned int styleNumber_, bool unicode_, std::string_view sv, const XYPOSITION *positions_, uint16_t clock_);
+	void Set(const Font *font_, bool unicode_, std::string_view sv, const XYPOSITION *positions_, uint16_t clock_);
 	void Clear() noexcept;
-	bool Retrieve(unsigned int styleNumber_, bool unicode_, std::string_view sv, XYPOSITION *positions_) const noexcept;
-	static size_t Hash(unsigned int styleNumber_, bool unicode_, std::string_view sv) noexcept;
+	bool Retrieve(const Font *font_, bool unicode_, std::string_view sv, XYPOSITION *positions_) const noexcept;
+	static size_t Hash(const Font *font_, bool unicode_, std::string_view sv) noexcept;
 	[[nodiscard]] bool NewerThan(const PositionCacheEntry &other) const noexcept;
 	void ResetClock() noexcept;
 };
@@ -1021,7 +1032,7 @@ PositionCacheEntry::PositionCacheEntry() noexcept = default;
 
 // Copy constructor not currently used, but needed for being element in std::vector.
 PositionCacheEntry::PositionCacheEntry(const PositionCacheEntry &other) :
-	styleNumber(other.styleNumber), len(other.len), clock(other.clock), unicode(other.unicode) {
+	font(other.font), len(other.len), clock(other.clock), unicode(other.unicode) {
 	if (other.positions) {
 		const size_t lenData = len + (len / sizeof(XYPOSITION)) + 1;
 		positions = std::make_unique<XYPOSITION[]>(lenData);
@@ -1029,10 +1040,10 @@ PositionCacheEntry::PositionCacheEntry(const PositionCacheEntry &other) :
 	}
 }
 
-void PositionCacheEntry::Set(unsigned int styleNumber_, bool unicode_, std::string_view sv,
+void PositionCacheEntry::Set(const Font *font_, bool unicode_, std::string_view sv,
 	const XYPOSITION *positions_, uint16_t clock_) {
 	Clear();
-	styleNumber = static_cast<uint16_t>(styleNumber_);
+	font = font_;
 	len = static_cast<uint16_t>(sv.length());
 	clock = clock_;
 	unicode = unicode_;
@@ -1051,13 +1062,13 @@ PositionCacheEntry::~PositionCacheEntry() {
 
 void PositionCacheEntry::Clear() noexcept {
 	positions.reset();
-	styleNumber = 0;
+	font = nullptr;
 	len = 0;
 	clock = 0;
 }
 
-bool PositionCacheEntry::Retrieve(unsigned int styleNumber_, bool unicode_, std::string_view sv, XYPOSITION *positions_) const noexcept {
-	if ((styleNumber == styleNumber_) && (unicode == unicode_) && (len == sv.length()) &&
+bool PositionCacheEntry::Retrieve(const Font *font_, bool unicode_, std::string_view sv, XYPOSITION *positions_) const noexcept {
+	if (font && (font == font_) && (unicode == unicode_) && (len == sv.length()) &&
 		(memcmp(&positions[len], sv.data(), sv.length())== 0)) {
 		for (unsigned int i=0; i<len; i++) {
 			positions_[i] = positions[i];
@@ -1067,9 +1078,9 @@ bool PositionCacheEntry::Retrieve(unsigned int styleNumber_, bool unicode_, std:
 	return false;
 }
 
-size_t PositionCacheEntry::Hash(unsigned int styleNumber_, bool unicode_, std::string_view sv) noexcept {
+size_t PositionCacheEntry::Hash(const Font *font_, bool unicode_, std::string_view sv) noexcept {
 	const size_t h1 = std::hash<std::string_view>{}(sv);
-	const size_t h2 = std::hash<unsigned int>{}(styleNumber_);
+	const size_t h2 = std::hash<const Font *>{}(font_);
 	return h1 ^ (h2 << 1) ^ static_cast<size_t>(unicode_);
 }
 
@@ -1117,23 +1128,24 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 		}
 	}
 
+	const Font *fontStyle = style.font.get();
 	size_t probe = pces.size();	// Out of bounds
 	if ((!pces.empty()) && (sv.length() < 30)) {
 		// Only store short strings in the cache so it doesn't churn with
 		// long comments with only a single comment.
 
 		// Two way associative: try two probe positions.
-		const size_t hashValue = PositionCacheEntry::Hash(styleNumber, unicode, sv);
+		const size_t hashValue = PositionCacheEntry::Hash(fontStyle, unicode, sv);
 		probe = hashValue % pces.size();
 		std::unique_lock<std::mutex> guard(mutex, std::defer_lock);
 		if (needsLocking) {
 			guard.lock();
 		}
-		if (pces[probe].Retrieve(styleNumber, unicode, sv, positions)) {
+		if (pces[probe].Retrieve(fontStyle, unicode, sv, positions)) {
 			return;
 		}
 		const size_t probe2 = (hashValue * 37) % pces.size();
-		if (pces[probe2].Retrieve(styleNumber, unicode, sv, positions)) {
+		if (pces[probe2].Retrieve(fontStyle, unicode, sv, positions)) {
 			return;
 		}
 		// Not found. Choose the oldest of the two slots to replace
@@ -1142,7 +1154,6 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 		}
 	}
 
-	const Font *fontStyle = style.font.get();
 	if (unicode) {
 		surface->MeasureWidthsUTF8(fontStyle, sv, positions);
 	} else {
@@ -1164,7 +1175,7 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 			clock = 2;
 		}
 		allClear = false;
-		pces[probe].Set(styleNumber, unicode, sv, positions, clock);
+		pces[probe].Set(fontStyle, unicode, sv, positions, clock);
 	}
 }
 
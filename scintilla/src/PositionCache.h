@@ -58,6 +58,8 @@ public:
 	int maxLineLength;
 	int numCharsInLine;
 	int numCharsBeforeEOL;
+	/// The part of the line that was measured, positions outside it are estimated.
+	Range measured;
 	enum class ValidLevel { invalid, checkTextAndStyle, positions, lines } validity;
 	int xHighlightGuide;
 	bool highlightColumn;
@@ -238,6 +240,9 @@ public:
 	enum { lengthStartSubdivision = 300 };
 	// Try to make each subdivided run lengthEachSubdivision or shorter.
 	enum { lengthEachSubdivision = 100 };
+	// Drawing a long line only measured around its visible part starts at most this far
+	// before the first visible character.
+	enum { lengthBackToStyleBreak = 1000 };
 	enum class BreakFor {
 		Text = 0,
 		Selection = 1,
@@ -191,6 +191,81 @@ FillResult<DISTANCE> RunStyles<DISTANCE, STYLE>::FillRange(DISTANCE position, ST
 	return resultNoChange;
 }
 
+// Calling FillRange for each of many ranges moves the run data for each call.
+// Instead, merge the old runs with the ranges into new arrays and swap them in.
+template <typename DISTANCE, typename STYLE>
+FillResult<DISTANCE> RunStyles<DISTANCE, STYLE>::FillRanges(const DISTANCE *ranges, size_t rangeCount, STYLE value) {
+	const DISTANCE length = Length();
+	std::vector<DISTANCE> runStarts;
+	std::vector<STYLE> runStyles;
+	const auto append = [&runStarts, &runStyles](DISTANCE position, STYLE style) {
+		if (!runStarts.empty() && (runStarts.back() == position)) {
+			// Replace a run that turned out to be empty
+			runStarts.pop_back();
+			runStyles.pop_back();
+		}
+		if (runStyles.empty() || (runStyles.back() != style)) {
+			runStarts.push_back(position);
+			runStyles.push_back(style);
+		}
+	};
+
+	DISTANCE run = 0;
+	DISTANCE position = 0;
+	// Copy the old runs over [position, end)
+	const auto copyRuns = [&](DISTANCE end) {
+		if (position >= end) {
+			return;
+		}
+		while (starts.PositionFromPartition(run + 1) <= position) {
+			run++;
+		}
+		append(position, styles.ValueAt(run));
+		while (starts.PositionFromPartition(run + 1) < end) {
+			run++;
+			append(starts.PositionFromPartition(run), styles.ValueAt(run));
+		}
+	};
+
+	DISTANCE changeStart = length;
+	DISTANCE changeEnd = 0;
+	for (size_t i = 0; i < rangeCount; i++) {
+		const DISTANCE start = std::max(ranges[i * 2], position);
+		const DISTANCE end = std::min(ranges[i * 2 + 1], length);
+		if (start >= end) {
+			continue;
+		}
+		copyRuns(start);
+		// Find whether any old value inside the range differs
+		while (starts.PositionFromPartition(run + 1) <= start) {
+			run++;
+		}
+		for (DISTANCE r = run; starts.PositionFromPartition(r) < end; r++) {
+			if (styles.ValueAt(r) != value) {
+				changeStart = std::min(changeStart, start);
+				changeEnd = end;
+				break;
+			}
+		}
+		append(start, value);
+		position = end;
+	}
+	if (changeStart >= changeEnd) {
+		return { false, 0, 0 };
+	}
+	copyRuns(length);
+
+	starts.DeleteAll();
+	starts.InsertText(0, length);
+	starts.ReAllocate(runStarts.size() + 1);
+	starts.InsertPartitions(1, runStarts.data() + 1, runStarts.size() - 1);
+	styles.DeleteAll();
+	styles.ReAllocate(runStyles.size() + 1);
+	styles.InsertFromArray(0, runStyles.data(), 0, runStyles.size());
+	styles.InsertValue(runStyles.size(), 1, 0);
+	return { true, changeStart, changeEnd - changeStart };
+}
+
 template <typename DISTANCE, typename STYLE>
 void RunStyles<DISTANCE, STYLE>::SetValueAt(DISTANCE position, STYLE value) {
 	FillRange(position, value, 1);
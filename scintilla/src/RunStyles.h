@@ -41,6 +41,8 @@ public:
 	DISTANCE EndRun(DISTANCE position) const noexcept;
 	// Returns changed=true if some values may have changed
 	FillResult<DISTANCE> FillRange(DISTANCE position, STYLE value, DISTANCE fillLength);
+	// Fills rangeCount (start, end) pairs sorted by start in one pass over the runs
+	FillResult<DISTANCE> FillRanges(const DISTANCE *ranges, size_t rangeCount, STYLE value);
 	void SetValueAt(DISTANCE position, STYLE value);
 	void InsertSpace(DISTANCE position, DISTANCE insertLength);
 	void DeleteAll();
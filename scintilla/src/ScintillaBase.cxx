@@ -647,6 +647,10 @@ LexState *ScintillaBase::DocumentLexState() {
 	return dynamic_cast<LexState *>(pdoc->GetLexInterface());
 }
 
+void ScintillaBase::SetParallelLexing(unsigned int threads, LexerFactory factory) {
+	DocumentLexState()->SetParallelLexing(threads, factory);
+}
+
 const char *LexState::DescribeWordListSets() {
 	if (instance) {
 		return instance->DescribeWordListSets();
@@ -656,6 +660,7 @@ const char *LexState::DescribeWordListSets() {
 
 void LexState::SetWordList(int n, const char *wl) {
 	if (instance) {
+		RecordSetupStep({LexerSetupStep::Kind::WordList, n, 0, {}, wl});
 		const Sci_Position firstModification = instance->WordListSet(n, wl);
 		if (firstModification >= 0) {
 			pdoc->ModifiedAt(firstModification);
@@ -679,6 +684,8 @@ const char *LexState::GetName() const {
 
 void *LexState::PrivateCall(int operation, void *pointer) {
 	if (instance) {
+		// Can't be replayed on clones
+		parallelBroken = true;
 		return instance->PrivateCall(operation, pointer);
 	}
 	return nullptr;
@@ -707,6 +714,7 @@ const char *LexState::DescribeProperty(const char *name) {
 
 void LexState::PropSet(const char *key, const char *val) {
 	if (instance) {
+		RecordSetupStep({LexerSetupStep::Kind::Property, 0, 0, key, val});
 		const Sci_Position firstModification = instance->PropertySet(key, val);
 		if (firstModification >= 0) {
 			pdoc->ModifiedAt(firstModification);
@@ -740,6 +748,7 @@ LineEndType LexState::LineEndTypesSupported() {
 
 int LexState::AllocateSubStyles(int styleBase, int numberStyles) {
 	if (instance) {
+		RecordSetupStep({LexerSetupStep::Kind::AllocateSubStyles, styleBase, numberStyles, {}, {}});
 		return instance->AllocateSubStyles(styleBase, numberStyles);
 	}
 	return -1;
@@ -775,12 +784,14 @@ int LexState::PrimaryStyleFromStyle(int style) {
 
 void LexState::FreeSubStyles() {
 	if (instance) {
+		RecordSetupStep({LexerSetupStep::Kind::FreeSubStyles, 0, 0, {}, {}});
 		instance->FreeSubStyles();
 	}
 }
 
 void LexState::SetIdentifiers(int style, const char *identifiers) {
 	if (instance) {
+		RecordSetupStep({LexerSetupStep::Kind::SetIdentifiers, style, 0, {}, identifiers});
 		instance->SetIdentifiers(style, identifiers);
 		pdoc->ModifiedAt(0);
 	}
@@ -101,6 +101,9 @@ public:
 
 	// Public so scintilla_send_message can use it
 	Scintilla::sptr_t WndProc(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam) override;
+
+	// Applies to the current document, see ParallelLexing.cxx
+	void SetParallelLexing(unsigned int threads, LexerFactory factory);
 };
 
 }
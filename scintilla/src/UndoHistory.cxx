@@ -184,26 +184,84 @@ Sci::Position UndoActions::Length(int action) const noexcept {
 	return lengths.SignedValueAt(action);
 }
 
+void FileCloser::operator()(std::FILE *file) const noexcept {
+	std::fclose(file);
+}
+
 void ScrapStack::Clear() noexcept {
 	stack.clear();
 	current = 0;
+	spilled = 0;
+	spill.reset();
+}
+
+void ScrapStack::SetMemoryLimit(size_t limit) noexcept {
+	memoryLimit = limit;
+}
+
+// Moves the text before end to the spill file.
+void ScrapStack::Spill(size_t end) {
+	if (!spill) {
+		spill.reset(std::tmpfile());
+	}
+	const size_t length = end - spilled;
+	if (!spill || end > LONG_MAX ||
+		std::fseek(spill.get(), static_cast<long>(spilled), SEEK_SET) != 0 ||
+		std::fwrite(stack.data(), 1, length, spill.get()) != length ||
+		std::fflush(spill.get()) != 0) {
+		// Keep everything in memory from now on, the spilled text is still valid
+		memoryLimit = 0;
+		return;
+	}
+	stack.erase(0, length);
+	spilled = end;
 }
 
 const char *ScrapStack::Push(const char *text, size_t length) {
-	if (current < stack.length()) {
-		stack.resize(current);
+	if (current < spilled) {
+		// The text after current is dropped, and the text before is still in the file
+		stack.clear();
+		spilled = current;
+	}
+	if (current < spilled + stack.length()) {
+		stack.resize(current - spilled);
+	}
+	// Spill before appending so that the returned text stays valid, keeping half of the
+	// limit in memory as text near the current position is the most likely to be needed
+	if (memoryLimit && stack.length() + length > memoryLimit && current - spilled > memoryLimit / 2) {
+		Spill(current - memoryLimit / 2);
 	}
 	stack.append(text, length);
-	current = stack.length();
-	return stack.data() + current - length;
+	current = spilled + stack.length();
+	return stack.data() + current - spilled - length;
+}
+
+// Ensures the text from position on is in memory, reading back all the spilled text if needed.
+// Throws if it can't be read back, leaving the stack as it was.
+void ScrapStack::Load(size_t position) {
+	if (position >= spilled) {
+		return;
+	}
+	std::string text(spilled, '\0');
+	std::rewind(spill.get());
+	if (std::fread(text.data(), 1, spilled, spill.get()) != spilled) {
+		throw std::runtime_error("Failed to read back undo text");
+	}
+	stack.insert(0, text);
+	spilled = 0;
+	spill.reset();
 }
 
 void ScrapStack::SetCurrent(size_t position) noexcept {
 	current = position;
 }
 
+size_t ScrapStack::Current() const noexcept {
+	return current;
+}
+
 void ScrapStack::MoveForward(size_t length) noexcept {
-	if ((current + length) <= stack.length()) {
+	if ((current + length) <= spilled + stack.length()) {
 		current += length;
 	}
 }
@@ -214,12 +272,13 @@ void ScrapStack::MoveBack(size_t length) noexcept {
 	}
 }
 
+// Only valid for text loaded with Load
 const char *ScrapStack::CurrentText() const noexcept {
-	return stack.data() + current;
+	return stack.data() + current - spilled;
 }
 
 const char *ScrapStack::TextAt(size_t position) const noexcept {
-	return stack.data() + position;
+	return stack.data() + position - spilled;
 }
 
 // The undo history stores a sequence of user operations that represent the user's view of the
@@ -375,6 +434,11 @@ void UndoHistory::DeleteUndoHistory() noexcept {
 	memory = {};
 }
 
+// Limits the memory used by the text of the actions, 0 for no limit.
+void UndoHistory::SetMemoryLimit(size_t limit) noexcept {
+	scraps->SetMemoryLimit(limit);
+}
+
 int UndoHistory::Actions() const noexcept {
 	return static_cast<int>(actions.SSize());
 }
@@ -511,6 +575,11 @@ std::string_view UndoHistory::Text(int action) noexcept {
 		position += actions.Length(act);
 	}
 	const size_t length = actions.Length(action);
+	try {
+		scraps->Load(position);
+	} catch (...) {
+		return {};
+	}
 	const char *scrap = scraps->TextAt(position);
 	memory = {action, position};
 	return {scrap, length};
@@ -550,10 +619,17 @@ bool UndoHistory::TentativeActive() const noexcept {
 	return tentativePoint >= 0;
 }
 
-int UndoHistory::TentativeSteps() const noexcept {
+int UndoHistory::TentativeSteps() {
 	// Drop any trailing startAction
-	if (tentativePoint >= 0)
+	if (tentativePoint >= 0) {
+		// The text of the steps may have been spilled
+		size_t lengthSteps = 0;
+		for (int step = tentativePoint; step < currentAction; step++) {
+			lengthSteps += actions.Length(step);
+		}
+		scraps->Load(scraps->Current() - lengthSteps);
 		return currentAction - tentativePoint;
+	}
 	return -1;
 }
 
@@ -561,7 +637,7 @@ bool UndoHistory::CanUndo() const noexcept {
 	return (currentAction > 0) && (actions.SSize() != 0);
 }
 
-int UndoHistory::StartUndo() const noexcept {
+int UndoHistory::StartUndo() {
 	assert(currentAction >= 0);
 
 	// Count the steps in this action
@@ -574,6 +650,13 @@ int UndoHistory::StartUndo() const noexcept {
 	while (act > 0 && !actions.AtStart(act)) {
 		act--;
 	}
+
+	// The text of the steps may have been spilled
+	size_t lengthSteps = 0;
+	for (int step = act; step < currentAction; step++) {
+		lengthSteps += actions.Length(step);
+	}
+	scraps->Load(scraps->Current() - lengthSteps);
 	return currentAction - act;
 }
 
@@ -601,13 +684,14 @@ bool UndoHistory::CanRedo() const noexcept {
 	return actions.SSize() > currentAction;
 }
 
-int UndoHistory::StartRedo() const noexcept {
+int UndoHistory::StartRedo() {
 	// Count the steps in this action
 
 	if (currentAction >= actions.SSize()) {
 		// Already at end so can't redo
 		return 0;
 	}
+	scraps->Load(scraps->Current());
 
 	// Slightly unusual logic handles case where last action still has mayCoalesce.
 	// Could set mayCoalesce of last action to false in StartUndo but this state is
@@ -62,13 +62,26 @@ struct UndoActions {
 	[[nodiscard]] Sci::Position Length(int action) const noexcept;
 };
 
+struct FileCloser {
+	void operator()(std::FILE *file) const noexcept;
+};
+
+// The text of the actions, in order. When it grows beyond its memory limit, the oldest text is
+// spilled to a temporary file and only brought back when undo reaches it.
 class ScrapStack {
-	std::string stack;
+	std::string stack;	// The text after the spilled text
 	size_t current = 0;
+	size_t spilled = 0;
+	size_t memoryLimit = 0;
+	std::unique_ptr<std::FILE, FileCloser> spill;
+	void Spill(size_t end);
 public:
 	void Clear() noexcept;
+	void SetMemoryLimit(size_t limit) noexcept;
 	const char *Push(const char *text, size_t length);
+	void Load(size_t position);
 	void SetCurrent(size_t position) noexcept;
+	[[nodiscard]] size_t Current() const noexcept;
 	void MoveForward(size_t length) noexcept;
 	void MoveBack(size_t length) noexcept;
 	[[nodiscard]] const char *CurrentText() const noexcept;
@@ -105,6 +118,7 @@ public:
 	bool AfterUndoSequenceStart() const noexcept;
 	void DropUndoSequence() noexcept;
 	void DeleteUndoHistory() noexcept;
+	void SetMemoryLimit(size_t limit) noexcept;
 
 	[[nodiscard]] int Actions() const noexcept;
 
@@ -142,16 +156,16 @@ public:
 	void TentativeStart() noexcept;
 	void TentativeCommit() noexcept;
 	bool TentativeActive() const noexcept;
-	int TentativeSteps() const noexcept;
+	int TentativeSteps();
 
 	/// To perform an undo, StartUndo is called to retrieve the number of steps, then UndoStep is
 	/// called that many times. Similarly for redo.
 	bool CanUndo() const noexcept;
-	int StartUndo() const noexcept;
+	int StartUndo();
 	Action GetUndoStep() const noexcept;
 	void CompletedUndoStep() noexcept;
 	bool CanRedo() const noexcept;
-	int StartRedo() const noexcept;
+	int StartRedo();
 	Action GetRedoStep() const noexcept;
 	void CompletedRedoStep() noexcept;
 };
@@ -50,6 +50,7 @@
 #include "sidebar.h"
 #include "support.h"
 #include "symbols.h"
+#include "tm_ctags.h"
 #include "ui_utils.h"
 #include "utils.h"
 #include "vte.h"
@@ -106,6 +107,16 @@ enum
 
 static guint doc_id_counter = 0;
 
+/* Set while load_text_file_in_background() runs its nested main loop, which could otherwise
+ * re-enter document_open_file_full() (e.g. through the socket or a plugin) or close the
+ * document being reloaded. */
+static struct
+{
+	gboolean		 running;
+	GeanyDocument	*doc;	/* the document being reloaded, if any */
+}
+background_load_state = { FALSE, NULL };
+
 
 static void document_undo_clear_stack(GSList **stack);
 static void document_undo_clear(GeanyDocument *doc);
@@ -647,6 +658,13 @@ static gboolean remove_page(guint page_num)
 
 	g_return_val_if_fail(doc != NULL, FALSE);
 
+	if (doc == background_load_state.doc)
+	{
+		ui_set_statusbar(TRUE, _("The file \"%s\" cannot be closed while it is loading."),
+			DOC_FILENAME(doc));
+		return FALSE;
+	}
+
 	/* if we're closing all, document_account_for_unsaved() has been called already, no need to ask again. */
 	if (! main_status.closing_all && doc->changed && ! dialogs_show_unsaved_file(doc))
 		return FALSE;
@@ -866,6 +884,10 @@ typedef struct
 	gboolean	 bom;
 	time_t		 mtime;	/* modification time, read by stat::st_mtime */
 	gboolean	 readonly;
+	gint		 eol_mode;
+	gsize		 lines;		/* line count, to size Scintilla's line index up front */
+	gpointer	 sci_doc;	/* Scintilla document holding the text if data is NULL */
+	gboolean	 huge;		/* opened in huge file mode, see file_prefs.huge_file_size */
 } FileData;
 
 
@@ -918,17 +940,60 @@ static gboolean get_mtime(const gchar *locale_filename, time_t *time)
 }
 
 
-/* loads textfile data, verifies and converts to forced_enc or UTF-8. Also handles BOM. */
-static gboolean load_text_file(const gchar *locale_filename, const gchar *display_filename,
-	FileData *filedata, const gchar *forced_enc)
+static void report_conversion_error(const gchar *display_filename, const gchar *forced_enc,
+	GError *err)
 {
-	GError *err = NULL;
+	if (forced_enc)
+		ui_set_statusbar(TRUE, _("Failed to load file \"%s\" as %s: %s."),
+			display_filename, forced_enc, err->message);
+	else
+		ui_set_statusbar(TRUE, _("Failed to load file \"%s\": %s."),
+			display_filename, err->message);
+}
+
 
+static void warn_if_truncated(const gchar *display_filename, FileData *filedata)
+{
+	if (filedata->readonly)
+	{
+		gchar *warn_msg = g_strdup_printf(_(
+			"The file \"%s\" could not be opened properly and has been truncated. "
+			"This can occur if the file contains a NULL byte. "
+			"Be aware that saving it can cause data loss.\nThe file was set to read-only."),
+			display_filename);
+
+		if (main_status.main_window_realized)
+			dialogs_show_msgbox(GTK_MESSAGE_WARNING, "%s", warn_msg);
+
+		ui_set_statusbar(TRUE, "%s", warn_msg);
+
+		g_free(warn_msg);
+	}
+}
+
+
+static void init_file_data(FileData *filedata)
+{
 	filedata->data = NULL;
 	filedata->len = 0;
 	filedata->enc = NULL;
 	filedata->bom = FALSE;
 	filedata->readonly = FALSE;
+	filedata->eol_mode = file_prefs.default_eol_character;
+	filedata->lines = 0;
+	filedata->sci_doc = NULL;
+	filedata->huge = FALSE;
+}
+
+
+/* loads textfile data, verifies and converts to forced_enc or UTF-8. Also handles BOM. */
+static gboolean load_text_file(const gchar *locale_filename, const gchar *display_filename,
+	FileData *filedata, const gchar *forced_enc)
+{
+	GError *err = NULL;
+	GeanyTextScan scan;
+
+	init_file_data(filedata);
 
 	if (!get_mtime(locale_filename, &filedata->mtime))
 		return FALSE;
@@ -950,35 +1015,519 @@ static gboolean load_text_file(const gchar *locale_filename, const gchar *displa
 		return FALSE;
 	}
 
-	if (! encodings_convert_to_utf8_auto(&filedata->data, &filedata->len, forced_enc,
-				&filedata->enc, &filedata->bom, &filedata->readonly, &err))
+	if (! encodings_convert_to_utf8_auto_scan(&filedata->data, &filedata->len, forced_enc,
+				&filedata->enc, &filedata->bom, &scan, &err))
 	{
-		if (forced_enc)
-			ui_set_statusbar(TRUE, _("Failed to load file \"%s\" as %s: %s."),
-				display_filename, forced_enc, err->message);
-		else
-			ui_set_statusbar(TRUE, _("Failed to load file \"%s\": %s."),
-				display_filename, err->message);
+		report_conversion_error(display_filename, forced_enc, err);
 		g_error_free(err);
 		g_free(filedata->data);
 		return FALSE;
 	}
 
-	if (filedata->readonly)
+	filedata->readonly = scan.nul_pos != filedata->len;
+	filedata->eol_mode = scan.eol_mode;
+	filedata->lines = scan.lines;
+	warn_if_truncated(display_filename, filedata);
+
+	return TRUE;
+}
+
+
+#define BACKGROUND_LOAD_CHUNK_SIZE (1024 * 1024)
+
+typedef struct
+{
+	/* set up by the main thread before the worker starts */
+	const gchar		*locale_filename;
+	const gchar		*forced_enc;
+	gsize			 size;		/* on-disk size, for progress */
+	gboolean		 huge;		/* stream the file to the loader, see load_huge_file() */
+	FileData		*filedata;
+	gpointer		 loader;	/* see scintilla_loader_new() */
+	GCancellable	*cancellable;
+	GMainLoop		*loop;
+	GtkWidget		*progress_bar;
+	/* shared */
+	gint			 progress;	/* per mille, accessed atomically */
+	/* set by the worker */
+	gboolean		 conversion_failed;
+	GError			*error;
+} BackgroundLoad;
+
+
+static gboolean background_load_finished(gpointer data)
+{
+	BackgroundLoad *load = data;
+
+	g_main_loop_quit(load->loop);
+	return G_SOURCE_REMOVE;
+}
+
+
+static gboolean background_load_update_progress(gpointer data)
+{
+	BackgroundLoad *load = data;
+
+	gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(load->progress_bar),
+		g_atomic_int_get(&load->progress) / 1000.0);
+	return G_SOURCE_CONTINUE;
+}
+
+
+static gchar *background_load_read(BackgroundLoad *load, gsize *len)
+{
+	GFile *file = g_file_new_for_path(load->locale_filename);
+	GFileInputStream *stream;
+	GByteArray *bytes;
+	gssize n_read;
+
+	stream = g_file_read(file, load->cancellable, &load->error);
+	g_object_unref(file);
+	if (! stream)
+		return NULL;
+
+	bytes = g_byte_array_sized_new(load->size + BACKGROUND_LOAD_CHUNK_SIZE + 1);
+	do
 	{
-		gchar *warn_msg = g_strdup_printf(_(
-			"The file \"%s\" could not be opened properly and has been truncated. "
-			"This can occur if the file contains a NULL byte. "
-			"Be aware that saving it can cause data loss.\nThe file was set to read-only."),
-			display_filename);
+		guint offset = bytes->len;
 
-		if (main_status.main_window_realized)
-			dialogs_show_msgbox(GTK_MESSAGE_WARNING, "%s", warn_msg);
+		g_byte_array_set_size(bytes, offset + BACKGROUND_LOAD_CHUNK_SIZE);
+		n_read = g_input_stream_read(G_INPUT_STREAM(stream), bytes->data + offset,
+			BACKGROUND_LOAD_CHUNK_SIZE, load->cancellable, &load->error);
+		g_byte_array_set_size(bytes, offset + MAX(n_read, 0));
 
-		ui_set_statusbar(TRUE, "%s", warn_msg);
+		/* reading is the first half of the work */
+		if (load->size > 0)
+			g_atomic_int_set(&load->progress, (gint) MIN(500, 500 * (gdouble) bytes->len / load->size));
+	}
+	while (n_read > 0);
+	g_object_unref(stream);
 
-		g_free(warn_msg);
+	if (load->error)
+	{
+		g_byte_array_free(bytes, TRUE);
+		return NULL;
+	}
+
+	*len = bytes->len;
+	g_byte_array_append(bytes, (const guint8 *) "", 1);	/* NULL terminate */
+	return (gchar *) g_byte_array_free(bytes, FALSE);
+}
+
+
+static gboolean background_load_add_data(BackgroundLoad *load, const gchar *data, gsize len)
+{
+	if (scintilla_loader_add_data(load->loader, data, len) != SC_STATUS_OK)
+	{
+		g_set_error_literal(&load->error, G_IO_ERROR, G_IO_ERROR_NO_SPACE, g_strerror(ENOMEM));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+
+/* Finds the end of the last complete line in head, on a code unit boundary for the UTF-16
+ * and UTF-32 encodings, as cutting a unit in half would make the conversion fail.
+ * If there is none, returns the length of the complete units. */
+static gsize find_last_line_end(const gchar *head, gsize len, GeanyEncodingIndex idx)
+{
+	gsize unit = 1, nl = 0;	/* size of a code unit, and offset of the '\n' byte in it */
+	gsize end, i;
+
+	switch (idx)
+	{
+		case GEANY_ENCODING_UTF_16LE:
+		case GEANY_ENCODING_UCS_2LE:
+			unit = 2;
+			break;
+		case GEANY_ENCODING_UTF_16BE:
+		case GEANY_ENCODING_UCS_2BE:
+			unit = 2;
+			nl = 1;
+			break;
+		case GEANY_ENCODING_UTF_32LE:
+			unit = 4;
+			break;
+		case GEANY_ENCODING_UTF_32BE:
+			unit = 4;
+			nl = 3;
+			break;
+		default:
+			break;
+	}
+
+	for (end = len - len % unit; end > 0; end -= unit)
+	{
+		const gchar *u = head + end - unit;
+		gboolean found = u[nl] == '\n';
+
+		for (i = 0; found && i < unit; i++)
+			found = i == nl || u[i] == '\0';
+		if (found)
+			return end;
+	}
+	/* no complete line, but at least keep whole units */
+	return len - len % unit;
+}
+
+
+/* Detects the encoding, BOM and line endings of a huge file from its first complete lines.
+ * The NULs check is meaningless as huge files are never truncated. */
+static gboolean load_huge_file_detect(BackgroundLoad *load, const gchar *head, gsize len)
+{
+	FileData *filedata = load->filedata;
+	GeanyEncodingIndex idx;
+	gsize head_len;
+	gchar *text;
+	GeanyTextScan scan;
+
+	if (load->forced_enc)
+		idx = encodings_get_idx_from_charset(load->forced_enc);
+	else
+		idx = encodings_scan_unicode_bom(head, len, NULL);
+	head_len = find_last_line_end(head, len, idx);
+	if (head_len == 0)
+		head_len = len;
+	text = g_malloc(head_len + 1);
+	memcpy(text, head, head_len);
+	text[head_len] = '\0';
+
+	if (! encodings_convert_to_utf8_auto_scan(&text, &head_len, load->forced_enc,
+				&filedata->enc, &filedata->bom, &scan, &load->error))
+	{
+		load->conversion_failed = TRUE;
+		g_free(text);
+		return FALSE;
+	}
+	filedata->eol_mode = scan.eol_mode;
+	g_free(text);
+	return TRUE;
+}
+
+
+/* Returns a stream reading the file from offset, converted to UTF-8 from filedata->enc. */
+static GInputStream *load_huge_file_convert(BackgroundLoad *load, GInputStream *stream,
+		goffset offset)
+{
+	FileData *filedata = load->filedata;
+	GCharsetConverter *converter;
+	GInputStream *converted;
+
+	if (! g_seekable_seek(G_SEEKABLE(stream), offset, G_SEEK_SET, load->cancellable, &load->error))
+		return NULL;
+	if (utils_str_equal(filedata->enc, "UTF-8") ||
+		utils_str_equal(filedata->enc, encodings_get_charset_from_index(GEANY_ENCODING_NONE)))
+		return g_object_ref(stream);
+
+	converter = g_charset_converter_new("UTF-8", filedata->enc, &load->error);
+	if (! converter)
+	{
+		load->conversion_failed = TRUE;
+		return NULL;
+	}
+	converted = g_converter_input_stream_new(stream, G_CONVERTER(converter));
+	/* stream may be read again from the start */
+	g_filter_input_stream_set_close_base_stream(G_FILTER_INPUT_STREAM(converted), FALSE);
+	g_object_unref(converter);
+	return converted;
+}
+
+
+/* Feeds the loader from stream, starting at offset in the file for the progress.
+ * If UTF-8 data turns out to be invalid, fails without setting load->error, leaving the data
+ * up to the end of the invalid line in buffer, and its length in invalid_len. */
+static gboolean load_huge_file_stream(BackgroundLoad *load, GInputStream *stream, gchar *buffer,
+		gsize offset, gsize *invalid_len)
+{
+	gboolean validate = utils_str_equal(load->filedata->enc, "UTF-8");
+	gsize pending = 0;	/* incomplete UTF-8 sequence at the start of buffer */
+	gsize n_read, total = offset;
+
+	*invalid_len = 0;
+	do
+	{
+		gsize len, valid_len;
+
+		if (! g_input_stream_read_all(stream, buffer + pending, BACKGROUND_LOAD_CHUNK_SIZE - pending,
+					&n_read, load->cancellable, &load->error))
+		{
+			load->conversion_failed = g_error_matches(load->error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA) ||
+				g_error_matches(load->error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT);
+			return FALSE;
+		}
+		len = pending + n_read;
+		if (validate)
+		{
+			GeanyTextScan scan;
+
+			utils_scan_text(buffer, len, &scan);
+			valid_len = scan.valid_len;
+		}
+		else
+			valid_len = len;
+		/* an invalid sequence is only allowed at the end of the chunk if more follows */
+		if (len - valid_len >= 4 || (n_read == 0 && valid_len < len))
+		{
+			const gchar *eol = memchr(buffer + valid_len, '\n', len - valid_len);
+
+			*invalid_len = eol ? (gsize) (eol + 1 - buffer) : len;
+			return FALSE;
+		}
+		if (valid_len > 0 && ! background_load_add_data(load, buffer, valid_len))
+			return FALSE;
+		pending = len - valid_len;
+		memmove(buffer, buffer + valid_len, pending);
+
+		total += n_read;
+		if (load->size > 0)
+			g_atomic_int_set(&load->progress, (gint) MIN(1000, 1000 * (gdouble) total / load->size));
+	}
+	while (n_read > 0);
+	return TRUE;
+}
+
+
+/* Huge file mode: feeds the file to the loader while reading it, converting it on the fly,
+ * so that it is never held in memory besides the Scintilla document.
+ * The encoding is detected from the head of the file. If it was taken for UTF-8 but later
+ * data is not, it is detected again from the invalid data and the file is loaded again, as
+ * detecting from the whole file would have done. */
+static gboolean load_huge_file(BackgroundLoad *load)
+{
+	FileData *filedata = load->filedata;
+	GFile *file = g_file_new_for_path(load->locale_filename);
+	GInputStream *stream, *converted;
+	gchar *buffer = NULL;
+	gsize n_read, invalid_len;
+	guint bom_len = 0;
+	gint eol_mode;
+	gboolean ok = FALSE;
+
+	stream = G_INPUT_STREAM(g_file_read(file, load->cancellable, &load->error));
+	g_object_unref(file);
+	if (! stream)
+		return FALSE;
+
+	buffer = g_malloc(BACKGROUND_LOAD_CHUNK_SIZE);
+	if (! g_input_stream_read_all(stream, buffer, BACKGROUND_LOAD_CHUNK_SIZE, &n_read,
+				load->cancellable, &load->error) ||
+		! load_huge_file_detect(load, buffer, n_read))
+		goto done;
+
+	/* restart after the BOM, through a converter if needed */
+	if (filedata->bom)
+		encodings_scan_unicode_bom(buffer, n_read, &bom_len);
+	converted = load_huge_file_convert(load, stream, bom_len);
+	if (! converted)
+		goto done;
+	ok = load_huge_file_stream(load, converted, buffer, bom_len, &invalid_len);
+	g_object_unref(converted);
+	if (ok || invalid_len == 0)
+		goto done;
+
+	/* with a forced encoding or a BOM, invalid data is an error, like for other files */
+	if (load->forced_enc || filedata->bom)
+	{
+		load->conversion_failed = TRUE;
+		g_set_error(&load->error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+			_("Data is not valid UTF-8"));
+		goto done;
+	}
+
+	/* keep the line endings detected from the head */
+	eol_mode = filedata->eol_mode;
+	g_free(filedata->enc);
+	filedata->enc = NULL;
+	if (! load_huge_file_detect(load, buffer, invalid_len))
+		goto done;
+	filedata->bom = FALSE;
+	filedata->eol_mode = eol_mode;
+
+	scintilla_loader_release(load->loader);
+	load->loader = scintilla_loader_new(load->size, SC_DOCUMENTOPTION_STYLES_NONE);
+	if (! load->loader)
+	{
+		g_set_error_literal(&load->error, G_IO_ERROR, G_IO_ERROR_NO_SPACE, g_strerror(ENOMEM));
+		goto done;
+	}
+	converted = load_huge_file_convert(load, stream, 0);
+	if (! converted)
+		goto done;
+	/* the encoding was detected from invalid UTF-8, so the data is not validated again */
+	ok = load_huge_file_stream(load, converted, buffer, 0, &invalid_len);
+	g_object_unref(converted);
+
+done:
+	g_free(buffer);
+	g_object_unref(stream);
+	return ok;
+}
+
+
+/* Reads and converts the whole file, then feeds the result to the loader. */
+static gboolean load_whole_file(BackgroundLoad *load)
+{
+	FileData *filedata = load->filedata;
+	GeanyTextScan scan;
+	gsize text_len, offset;
+	gboolean ok = FALSE;
+
+	filedata->data = background_load_read(load, &filedata->len);
+	if (! filedata->data)
+		return FALSE;
+
+	if (! encodings_convert_to_utf8_auto_scan(&filedata->data, &filedata->len, load->forced_enc,
+				&filedata->enc, &filedata->bom, &scan, &load->error))
+	{
+		load->conversion_failed = TRUE;
+		goto done;
+	}
+	filedata->readonly = scan.nul_pos != filedata->len;
+	filedata->eol_mode = scan.eol_mode;
+	filedata->lines = scan.lines;
+	scintilla_loader_allocate_lines(load->loader, filedata->lines);
+
+	/* like sci_set_text(), stop at the first NUL if any */
+	text_len = scan.nul_pos;
+	for (offset = 0; offset < text_len; offset += BACKGROUND_LOAD_CHUNK_SIZE)
+	{
+		gsize chunk = MIN(BACKGROUND_LOAD_CHUNK_SIZE, text_len - offset);
+
+		if (g_cancellable_set_error_if_cancelled(load->cancellable, &load->error))
+			goto done;
+		if (! background_load_add_data(load, filedata->data + offset, chunk))
+			goto done;
+		g_atomic_int_set(&load->progress, (gint) (500 + 500 * (gdouble) (offset + chunk) / text_len));
 	}
+	ok = TRUE;
+
+done:
+	g_free(filedata->data);
+	filedata->data = NULL;
+	return ok;
+}
+
+
+/* Worker thread: reads and converts the file, and feeds the result to the loader. It
+ * must not touch any UI or document state, only load->filedata and the loader. The
+ * conversion may log debug messages, which log.c shows from the main thread. */
+static gpointer background_load_thread(gpointer data)
+{
+	BackgroundLoad *load = data;
+
+	if (load->huge ? load_huge_file(load) : load_whole_file(load))
+	{
+		load->filedata->sci_doc = scintilla_loader_convert_to_document(load->loader);
+		load->loader = NULL;
+	}
+	g_idle_add(background_load_finished, load);
+	return NULL;
+}
+
+
+/* Whether the file is big enough to be loaded by load_text_file_in_background(), and to
+ * be opened in huge file mode. */
+static gboolean use_background_load(const gchar *locale_filename, gsize *size, gboolean *huge)
+{
+	GStatBuf st;
+
+	if (g_stat(locale_filename, &st) != 0 || ! S_ISREG(st.st_mode))
+		return FALSE;
+
+	*size = st.st_size;
+	*huge = file_prefs.huge_file_size > 0 &&
+		st.st_size >= (goffset) file_prefs.huge_file_size * 1024;
+	return *huge || (file_prefs.background_load_size > 0 &&
+		st.st_size >= (goffset) file_prefs.background_load_size * 1024);
+}
+
+
+/* Like load_text_file(), but reads and converts the file and fills a new Scintilla document
+ * in a worker thread, so that the UI stays responsive on huge files. The main loop keeps
+ * running meanwhile, behind a modal dialog showing the progress and allowing to cancel.
+ * On success filedata->data is NULL and filedata->sci_doc holds the text.
+ * In huge file mode, the document has no styles and is converted while being read. */
+static gboolean load_text_file_in_background(const gchar *locale_filename,
+	const gchar *display_filename, FileData *filedata, const gchar *forced_enc, gsize size,
+	gboolean huge)
+{
+	BackgroundLoad load = { 0 };
+	GtkWidget *dialog;
+	GThread *thread;
+	guint progress_id;
+
+	init_file_data(filedata);
+
+	if (!get_mtime(locale_filename, &filedata->mtime))
+		return FALSE;
+
+	/* Geany uses int positions */
+	if (size >= G_MAXINT)
+	{
+		ui_set_statusbar(TRUE, _("Could not open file %s (%s)"), display_filename,
+			g_strerror(EFBIG));
+		return FALSE;
+	}
+
+	load.loader = scintilla_loader_new(size,
+		huge ? SC_DOCUMENTOPTION_STYLES_NONE : SC_DOCUMENTOPTION_DEFAULT);
+	if (! load.loader)
+	{
+		ui_set_statusbar(TRUE, _("Could not open file %s (%s)"), display_filename,
+			g_strerror(ENOMEM));
+		return FALSE;
+	}
+	load.locale_filename = locale_filename;
+	load.forced_enc = forced_enc;
+	load.size = size;
+	load.huge = huge;
+	load.filedata = filedata;
+	load.cancellable = g_cancellable_new();
+	load.loop = g_main_loop_new(NULL, FALSE);
+
+	dialog = gtk_message_dialog_new(GTK_WINDOW(main_widgets.window),
+		GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT, GTK_MESSAGE_INFO, GTK_BUTTONS_CANCEL,
+		_("Loading \"%s\"..."), display_filename);
+	gtk_window_set_title(GTK_WINDOW(dialog), _("Opening File"));
+	load.progress_bar = gtk_progress_bar_new();
+	gtk_box_pack_start(GTK_BOX(gtk_message_dialog_get_message_area(GTK_MESSAGE_DIALOG(dialog))),
+		load.progress_bar, FALSE, FALSE, 0);
+	/* the dialog isn't destroyed by closing it, which also emits a response */
+	g_signal_connect_swapped(dialog, "response", G_CALLBACK(g_cancellable_cancel), load.cancellable);
+	gtk_widget_show_all(dialog);
+
+	progress_id = g_timeout_add(100, background_load_update_progress, &load);
+	thread = g_thread_new("geany-load", background_load_thread, &load);
+	g_main_loop_run(load.loop);
+	g_thread_join(thread);
+
+	g_source_remove(progress_id);
+	gtk_widget_destroy(dialog);
+	g_main_loop_unref(load.loop);
+	g_object_unref(load.cancellable);
+
+	if (load.loader)
+		scintilla_loader_release(load.loader);
+
+	if (load.error)
+	{
+		if (load.conversion_failed)
+			report_conversion_error(display_filename, forced_enc, load.error);
+		else if (g_error_matches(load.error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			ui_set_statusbar(FALSE, _("Opening of \"%s\" cancelled."), display_filename);
+		else
+			ui_set_statusbar(TRUE, _("Could not open file %s (%s)"), display_filename,
+				load.error->message);
+		g_error_free(load.error);
+		g_free(filedata->enc);
+		return FALSE;
+	}
+
+	warn_if_truncated(display_filename, filedata);
+	filedata->huge = huge;
+	if (huge)
+		ui_set_statusbar(TRUE, _("The file \"%s\" is very large, it was opened read-only "
+			"and without highlighting."), display_filename);
 
 	return TRUE;
 }
@@ -1246,6 +1795,9 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 	gchar *locale_filename = NULL;
 	GeanyFiletype *use_ft;
 	FileData filedata;
+	gsize file_size;
+	gboolean huge = FALSE;
+	gboolean loaded;
 	UndoReloadData *undo_reload_data;
 	gboolean add_undo_reload_action;
 
@@ -1283,9 +1835,31 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 	}
 	if (reload || doc == NULL)
 	{	/* doc possibly changed */
+		if (background_load_state.running)
+		{
+			ui_set_statusbar(TRUE, _("Could not open file %s (another file is loading)"),
+				utf8_filename);
+			g_free(utf8_filename);
+			g_free(locale_filename);
+			return NULL;
+		}
+
 		display_filename = utils_str_middle_truncate(utf8_filename, 100);
 
-		if (! load_text_file(locale_filename, display_filename, &filedata, forced_enc))
+		/* Reloading keeps its undo history through sci_set_text(), so it is never done in
+		 * the background, unless in huge file mode where there is little to keep. */
+		if (use_background_load(locale_filename, &file_size, &huge) && (! reload || huge))
+		{
+			background_load_state.running = TRUE;
+			background_load_state.doc = doc;
+			loaded = load_text_file_in_background(locale_filename, display_filename, &filedata,
+				forced_enc, file_size, huge);
+			background_load_state.running = FALSE;
+			background_load_state.doc = NULL;
+		}
+		else
+			loaded = load_text_file(locale_filename, display_filename, &filedata, forced_enc);
+		if (! loaded)
 		{
 			g_free(display_filename);
 			g_free(utf8_filename);
@@ -1305,7 +1879,7 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 			monitor_file_setup(doc);
 		}
 
-		if (! reload || ! file_prefs.keep_edit_history_on_reload)
+		if (! reload || ! file_prefs.keep_edit_history_on_reload || filedata.sci_doc)
 		{
 			sci_set_undo_collection(doc->editor->sci, FALSE); /* avoid creation of an undo action */
 			sci_empty_undo_buffer(doc->editor->sci);
@@ -1333,11 +1907,28 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 
 		/* add the text to the ScintillaObject */
 		sci_set_readonly(doc->editor->sci, FALSE);	/* to allow replacing text */
-		sci_set_text(doc->editor->sci, filedata.data);	/* NULL terminated data */
+		if (filedata.sci_doc)
+		{
+			SSM(doc->editor->sci, SCI_SETDOCPOINTER, 0, (sptr_t) filedata.sci_doc);
+			SSM(doc->editor->sci, SCI_RELEASEDOCUMENT, 0, (sptr_t) filedata.sci_doc);
+			/* the code page and indentation belong to the document, not the view */
+			sci_set_codepage(doc->editor->sci, SC_CP_UTF8);
+			editor_set_undo_memory_limit(doc->editor);
+			if (reload)
+				editor_set_indent(doc->editor, doc->editor->indent_type, doc->editor->indent_width);
+		}
+		else
+		{
+			/* SCI_SETTEXT drops the line index of a non-empty document, so this only helps
+			 * when opening */
+			if (sci_get_length(doc->editor->sci) == 0)
+				SSM(doc->editor->sci, SCI_ALLOCATELINES, filedata.lines, 0);
+			sci_set_text(doc->editor->sci, filedata.data);	/* NULL terminated data */
+		}
 		queue_colourise(doc);	/* Ensure the document gets colourised. */
 
-		/* detect & set line endings */
-		editor_mode = utils_get_line_endings(filedata.data, filedata.len);
+		/* set line endings */
+		editor_mode = filedata.eol_mode;
 		if (undo_reload_data)
 		{
 			undo_reload_data->eol_mode = editor_get_eol_char_mode(doc->editor);
@@ -1366,7 +1957,7 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 		doc->has_bom = filedata.bom;
 		store_saved_encoding(doc);	/* store the opened encoding for undo/redo */
 
-		doc->readonly = readonly || filedata.readonly;
+		doc->readonly = readonly || filedata.readonly || filedata.huge;
 		sci_set_readonly(doc->editor->sci, doc->readonly);
 		doc->priv->protected = 0;
 
@@ -1416,6 +2007,9 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 
 			use_ft = ft;
 		}
+		/* huge documents have no styles to highlight */
+		if (filedata.huge)
+			use_ft = filetypes[GEANY_FILETYPES_NONE];
 		/* update taglist, typedef keywords and build menu if necessary */
 		document_set_filetype(doc, use_ft);
 
@@ -1628,25 +2222,12 @@ static void document_update_timestamp(GeanyDocument *doc, const gchar *locale_fi
  * byte_pos is the position counted in bytes, not characters */
 static void get_line_column_from_pos(GeanyDocument *doc, guint byte_pos, gint *line, gint *column)
 {
-	gint i;
 	gint line_start;
 
-	/* for some reason we can use byte count instead of character count here */
 	*line = sci_get_line_from_position(doc->editor->sci, byte_pos);
 	line_start = sci_get_position_from_line(doc->editor->sci, *line);
-	/* get the column in the line */
-	*column = byte_pos - line_start;
-
-	/* any non-ASCII characters are encoded with two bytes(UTF-8, always in Scintilla), so
-	 * skip one byte(i++) and decrease the column number which is based on byte count */
-	for (i = line_start; i < (line_start + *column); i++)
-	{
-		if (sci_get_char_at(doc->editor->sci, i) < 0)
-		{
-			(*column)--;
-			i++;
-		}
-	}
+	/* get the column in the line, counted in characters */
+	*column = sci_count_characters(doc->editor->sci, line_start, byte_pos);
 }
 
 
@@ -2596,6 +3177,7 @@ void document_update_tags(GeanyDocument *doc)
 {
 	guchar *buffer_ptr;
 	gsize len;
+	gboolean was_partial;
 
 	g_return_if_fail(DOC_VALID(doc));
 	g_return_if_fail(app->tm_workspace != NULL);
@@ -2639,7 +3221,16 @@ void document_update_tags(GeanyDocument *doc)
 	 * Note: this buffer *MUST NOT* be modified */
 	len = sci_get_length(doc->editor->sci);
 	buffer_ptr = (guchar *) SSM(doc->editor->sci, SCI_GETCHARACTERPOINTER, 0, 0);
+	was_partial = doc->tm_file->partial;
+	tm_ctags_set_parse_budget((gsize) MAX(file_prefs.symbols_parse_max_size, 0) * 1024,
+		MAX(file_prefs.symbols_parse_timeout, 0));
 	tm_workspace_update_source_file_buffer(doc->tm_file, buffer_ptr, len);
+	tm_ctags_set_parse_budget(0, 0);
+
+	/* only report when the file becomes partial, not on every re-parse */
+	if (doc->tm_file->partial && ! was_partial)
+		ui_set_statusbar(TRUE, _("Symbol list of \"%s\" is incomplete: parsing was stopped early."),
+			DOC_FILENAME(doc));
 
 	sidebar_update_tag_list(doc, TRUE);
 	document_highlight_tags(doc);
@@ -3319,7 +3910,7 @@ GeanyDocument *document_clone(GeanyDocument *old_doc)
 	doc->has_bom = old_doc->has_bom;
 	doc->priv->protected = 0;
 	document_set_encoding(doc, old_doc->encoding);
-	sci_set_lines_wrapped(doc->editor->sci, doc->editor->line_wrapping);
+	editor_set_line_wrapping(doc->editor, doc->editor->line_wrapping);
 	sci_set_readonly(doc->editor->sci, doc->readonly);
 
 	/* update ui */
@@ -67,6 +67,10 @@ typedef struct GeanyFilePrefs
 	gboolean		show_keep_edit_history_on_reload_msg; /* whether to show the message introducing the above feature */
  	gboolean		reload_clean_doc_on_file_change;
  	gboolean		save_config_on_file_change;
+	gint			symbols_parse_max_size; /* in KiB, 0 for no limit */
+	gint			symbols_parse_timeout; /* in milliseconds, 0 for no limit */
+	gint			background_load_size; /* in KiB, 0 to always load in the main thread */
+	gint			huge_file_size; /* in KiB, 0 to never open files in huge file mode */
 }
 GeanyFilePrefs;
 
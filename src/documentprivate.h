@@ -116,6 +116,8 @@ typedef struct GeanyDocumentPrivate
 	gchar			*tag_filter;
 	/* Group symbols in symbol tree by their type. */
 	gboolean		symbols_group_by_type;
+	/* GeanyMinimap next to the editor widget, created by notebook_new_tab(). */
+	GtkWidget		*minimap;
 }
 GeanyDocumentPrivate;
 
@@ -42,6 +42,7 @@
 #include "dialogs.h"
 #include "documentprivate.h"
 #include "filetypesprivate.h"
+#include "geanyminimap.h"
 #include "geanyobject.h"
 #include "highlighting.h"
 #include "keybindings.h"
@@ -886,103 +887,6 @@ static void on_char_added(GeanyEditor *editor, SCNotification *nt)
 }
 
 
-/* expand() and fold_changed() are copied from SciTE (thanks) to fix #1923350. */
-static void expand(ScintillaObject *sci, gint *line, gboolean doExpand,
-		gboolean force, gint visLevels, gint level)
-{
-	gint lineMaxSubord = SSM(sci, SCI_GETLASTCHILD, *line, level & SC_FOLDLEVELNUMBERMASK);
-	gint levelLine = level;
-	(*line)++;
-	while (*line <= lineMaxSubord)
-	{
-		if (force)
-		{
-			if (visLevels > 0)
-				SSM(sci, SCI_SHOWLINES, *line, *line);
-			else
-				SSM(sci, SCI_HIDELINES, *line, *line);
-		}
-		else
-		{
-			if (doExpand)
-				SSM(sci, SCI_SHOWLINES, *line, *line);
-		}
-		if (levelLine == -1)
-			levelLine = SSM(sci, SCI_GETFOLDLEVEL, *line, 0);
-		if (levelLine & SC_FOLDLEVELHEADERFLAG)
-		{
-			if (force)
-			{
-				if (visLevels > 1)
-					SSM(sci, SCI_SETFOLDEXPANDED, *line, 1);
-				else
-					SSM(sci, SCI_SETFOLDEXPANDED, *line, 0);
-				expand(sci, line, doExpand, force, visLevels - 1, -1);
-			}
-			else
-			{
-				if (doExpand)
-				{
-					if (!sci_get_fold_expanded(sci, *line))
-						SSM(sci, SCI_SETFOLDEXPANDED, *line, 1);
-					expand(sci, line, TRUE, force, visLevels - 1, -1);
-				}
-				else
-				{
-					expand(sci, line, FALSE, force, visLevels - 1, -1);
-				}
-			}
-		}
-		else
-		{
-			(*line)++;
-		}
-	}
-}
-
-
-static void fold_changed(ScintillaObject *sci, gint line, gint levelNow, gint levelPrev)
-{
-	if (levelNow & SC_FOLDLEVELHEADERFLAG)
-	{
-		if (! (levelPrev & SC_FOLDLEVELHEADERFLAG))
-		{
-			/* Adding a fold point */
-			SSM(sci, SCI_SETFOLDEXPANDED, line, 1);
-			if (!SSM(sci, SCI_GETALLLINESVISIBLE, 0, 0))
-				expand(sci, &line, TRUE, FALSE, 0, levelPrev);
-		}
-	}
-	else if (levelPrev & SC_FOLDLEVELHEADERFLAG)
-	{
-		if (! sci_get_fold_expanded(sci, line))
-		{	/* Removing the fold from one that has been contracted so should expand
-			 * otherwise lines are left invisible with no way to make them visible */
-			SSM(sci, SCI_SETFOLDEXPANDED, line, 1);
-			if (!SSM(sci, SCI_GETALLLINESVISIBLE, 0, 0))
-				expand(sci, &line, TRUE, FALSE, 0, levelPrev);
-		}
-	}
-	if (! (levelNow & SC_FOLDLEVELWHITEFLAG) &&
-			((levelPrev & SC_FOLDLEVELNUMBERMASK) > (levelNow & SC_FOLDLEVELNUMBERMASK)))
-	{
-		if (!SSM(sci, SCI_GETALLLINESVISIBLE, 0, 0)) {
-			/* See if should still be hidden */
-			gint parentLine = sci_get_fold_parent(sci, line);
-			if (parentLine < 0)
-			{
-				SSM(sci, SCI_SHOWLINES, line, line);
-			}
-			else if (sci_get_fold_expanded(sci, parentLine) &&
-					sci_get_line_is_visible(sci, parentLine))
-			{
-				SSM(sci, SCI_SHOWLINES, line, line);
-			}
-		}
-	}
-}
-
-
 static void ensure_range_visible(ScintillaObject *sci, gint posStart, gint posEnd,
 		gboolean enforcePolicy)
 {
@@ -1141,11 +1045,6 @@ static gboolean on_editor_notify(G_GNUC_UNUSED GObject *object, GeanyEditor *edi
 				/* get notified about undo changes */
 				document_undo_add(doc, UNDO_SCINTILLA, NULL);
 			}
-			if (editor_prefs.folding && (nt->modificationType & SC_MOD_CHANGEFOLD) != 0)
-			{
-				/* handle special fold cases, e.g. #1923350 */
-				fold_changed(sci, nt->line, nt->foldLevelNow, nt->foldLevelPrev);
-			}
 			if (nt->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))
 			{
 				document_update_tag_list_in_idle(doc);
@@ -4254,6 +4153,20 @@ void editor_indicator_set_on_range(GeanyEditor *editor, gint indic, gint start,
 }
 
 
+/* Like editor_indicator_set_on_range() for the n_ranges (start, end) pairs in ranges,
+ * which must be sorted by start, but much faster for many ranges. */
+void editor_indicator_set_on_ranges(GeanyEditor *editor, gint indic, const gintptr *ranges, gsize n_ranges)
+{
+	g_return_if_fail(editor != NULL);
+
+	if (n_ranges == 0)
+		return;
+
+	sci_indicator_set(editor->sci, indic);
+	scintilla_indicator_fill_ranges(editor->sci, ranges, n_ranges);
+}
+
+
 /* Inserts the given colour (format should be #...), if there is a selection starting with 0x...
  * the replacement will also start with 0x... */
 void editor_insert_color(GeanyEditor *editor, const gchar *colour)
@@ -4380,24 +4293,17 @@ const gchar *editor_get_eol_char(GeanyEditor *editor)
 
 static void fold_all(GeanyEditor *editor, gboolean want_fold)
 {
-	gint lines, first, i;
+	gint first;
 
 	if (editor == NULL || ! editor_prefs.folding)
 		return;
 
-	lines = sci_get_line_count(editor->sci);
 	first = sci_get_first_visible_line(editor->sci);
 
-	for (i = 0; i < lines; i++)
-	{
-		gint level = sci_get_fold_level(editor->sci, i);
-
-		if (level & SC_FOLDLEVELHEADERFLAG)
-		{
-			if (sci_get_fold_expanded(editor->sci, i) == want_fold)
-					sci_toggle_fold(editor->sci, i);
-		}
-	}
+	/* let Scintilla (un)fold every fold point in one pass, toggling them one by one
+	 * is very slow on big documents */
+	SSM(editor->sci, SCI_FOLDALL, want_fold ?
+		SC_FOLDACTION_CONTRACT | SC_FOLDACTION_CONTRACT_EVERY_LEVEL : SC_FOLDACTION_EXPAND, 0);
 	editor_scroll_to_line(editor, first, 0.0F);
 }
 
@@ -4634,7 +4540,12 @@ static void set_font(ScintillaObject *sci, const gchar *font)
 	pango_font_description_free(pfd);
 
 	for (style = 0; style <= STYLE_MAX; style++)
+	{
 		sci_set_font_fractional(sci, style, font_name, size);
+		/* let Scintilla check whether the font has the same width for all ASCII characters,
+		 * in which case it computes their positions instead of measuring them with Pango */
+		SSM(sci, SCI_STYLESETCHECKMONOSPACED, (uptr_t) style, TRUE);
+	}
 
 	g_free(font_name);
 }
@@ -4656,6 +4567,8 @@ void editor_set_line_wrapping(GeanyEditor *editor, gboolean wrap)
 	g_return_if_fail(editor != NULL);
 
 	editor->line_wrapping = wrap;
+	/* wrap the lines out of view on layout threads rather than in idle time on this one */
+	scintilla_set_background_wrap(editor->sci, wrap);
 	sci_set_lines_wrapped(editor->sci, wrap);
 }
 
@@ -4803,6 +4716,100 @@ on_editor_scroll_event(GtkWidget *widget, GdkEventScroll *event, gpointer user_d
 }
 
 
+/* Whether the document's lexer keeps all its state in the document styles and line states,
+ * so that independent chunks of the document can be lexed in parallel. */
+static gboolean lexer_supports_parallel_lexing(GeanyEditor *editor)
+{
+	switch (sci_get_lexer(editor->sci))
+	{
+		/* not SCLEX_XML, LexHTML keeps checkpoints inside tags in the lexer */
+		case SCLEX_PROPERTIES:
+		case SCLEX_DIFF:
+		case SCLEX_MAKEFILE:
+		case SCLEX_YAML:
+		case SCLEX_BATCH:
+			return TRUE;
+		case SCLEX_CPP:
+			/* the preprocessor state is kept in the lexer, but JSON has none */
+			return editor->document->file_type == filetypes_lookup_by_name("JSON");
+		default:
+			return FALSE;
+	}
+}
+
+
+/* Styles the whole document. Big documents are styled in idle time by Scintilla instead, only
+ * restyling the visible lines right away if the lexer state at their start is already known
+ * (e.g. after a keywords change), unless their lexer can style them in parallel. */
+static void colourise_document(GeanyEditor *editor)
+{
+	ScintillaObject *sci = editor->sci;
+	gint length = sci_get_length(sci);
+	guint threads = 1;
+	gint first_line, last_line, start, end;
+
+	if (editor_prefs.parallel_lexing_size > 0 &&
+		length >= editor_prefs.parallel_lexing_size * 1024 &&
+		lexer_supports_parallel_lexing(editor))
+	{
+		threads = g_get_num_processors();
+	}
+	sci_set_parallel_lexing(sci, threads);
+
+	/* Idle styling goes in steps too small to be split over threads, so parallel lexing styles
+	 * the whole document at once instead, but only up to the size that takes about as long as
+	 * the largest document styled at once without it. Past that, the UI would block too long. */
+	if (editor_prefs.idle_styling_size <= 0 ||
+		length / (gint) threads < editor_prefs.idle_styling_size * 1024)
+	{
+		SSM(sci, SCI_SETIDLESTYLING, SC_IDLESTYLING_NONE, 0);
+		sci_colourise(sci, 0, -1);
+		return;
+	}
+
+	SSM(sci, SCI_SETIDLESTYLING, SC_IDLESTYLING_ALL, 0);
+
+	first_line = SSM(sci, SCI_DOCLINEFROMVISIBLE, sci_get_first_visible_line(sci), 0);
+	last_line = SSM(sci, SCI_DOCLINEFROMVISIBLE,
+		sci_get_first_visible_line(sci) + SSM(sci, SCI_LINESONSCREEN, 0, 0), 0);
+	start = sci_get_position_from_line(sci, first_line);
+	end = sci_get_line_end_position(sci, last_line);
+	if (start > 0 && start <= sci_get_end_styled(sci))
+		sci_colourise(sci, start, end);
+
+	/* everything from the start has to be restyled, bounded styling when drawing and idle
+	 * styling take care of it */
+	SSM(sci, SCI_STARTSTYLING, 0, 0);
+	gtk_widget_queue_draw(GTK_WIDGET(sci));
+}
+
+
+static guint current_function_timeout = 0;
+
+
+/* Whether the caret line is styled, so that its fold points are accurate */
+static gboolean caret_line_styled(ScintillaObject *sci)
+{
+	return sci_get_end_styled(sci) >= sci_get_line_end_position(sci, sci_get_current_line(sci));
+}
+
+
+static gboolean delay_update_current_function(G_GNUC_UNUSED gpointer user_data)
+{
+	GeanyDocument *doc = document_get_current();
+
+	/* wait for idle styling to reach the caret line, unless it stopped */
+	if (doc != NULL && ! caret_line_styled(doc->editor->sci) &&
+		SSM(doc->editor->sci, SCI_GETIDLESTYLING, 0, 0) != SC_IDLESTYLING_NONE)
+		return G_SOURCE_CONTINUE;
+
+	current_function_timeout = 0;
+	symbols_get_current_function(NULL, NULL);
+	ui_update_statusbar(NULL);
+	return G_SOURCE_REMOVE;
+}
+
+
 static gboolean editor_check_colourise(GeanyEditor *editor)
 {
 	GeanyDocument *doc = editor->document;
@@ -4811,12 +4818,17 @@ static gboolean editor_check_colourise(GeanyEditor *editor)
 		return FALSE;
 
 	doc->priv->colourise_needed = FALSE;
-	sci_colourise(editor->sci, 0, -1);
+	colourise_document(editor);
 
-	/* now that the current document is colourised, fold points are now accurate,
-	 * so force an update of the current function/tag. */
-	symbols_get_current_function(NULL, NULL);
-	ui_update_statusbar(NULL);
+	/* fold points are accurate once the caret line is colourised, so force an update of the
+	 * current function/tag then. Big documents are colourised in idle time, so it may be later. */
+	if (caret_line_styled(editor->sci))
+	{
+		symbols_get_current_function(NULL, NULL);
+		ui_update_statusbar(NULL);
+	}
+	else if (current_function_timeout == 0)
+		current_function_timeout = g_timeout_add(100, delay_update_current_function, NULL);
 
 	return TRUE;
 }
@@ -4948,6 +4960,7 @@ static ScintillaObject *create_new_sci(GeanyEditor *editor)
 
 	setup_sci_keys(sci);
 
+	scintilla_set_background_wrap(sci, editor->line_wrapping);
 	sci_set_lines_wrapped(sci, editor->line_wrapping);
 	sci_set_caret_policy_x(sci, CARET_JUMPS | CARET_EVEN, 0);
 	/* Y policy is set in editor_apply_update_prefs() */
@@ -5218,6 +5231,8 @@ void editor_apply_update_prefs(GeanyEditor *editor)
 	sci_set_eol_representation_characters(sci, sci_get_eol_mode(sci));
 
 	sci_set_folding_margin_visible(sci, editor_prefs.folding);
+	/* keep fold points expanded and their lines visible when fold levels change, e.g. #1923350 */
+	SSM(sci, SCI_SETAUTOMATICFOLD, editor_prefs.folding ? SC_AUTOMATICFOLD_CHANGE : 0, 0);
 
 	/* Override the default backwards cursor on margins with normal cursor */
 	margin_count = (guint) SSM(sci, SCI_GETMARGINS, 0, 0);
@@ -5248,6 +5263,30 @@ void editor_apply_update_prefs(GeanyEditor *editor)
 	sci_set_scroll_stop_at_last_line(sci, editor_prefs.scroll_stop_at_last_line);
 
 	sci_set_scrollbar_mode(sci, editor_prefs.show_scrollbars);
+
+	/* Lay out (mostly wrap) lines on several threads, and cache the layouts of at least the
+	 * visible lines as well as the widths of recurring words so that redrawing and resizing
+	 * don't measure the same text again */
+	SSM(sci, SCI_SETLAYOUTTHREADS, editor_prefs.layout_threads > 0 ?
+		(guint) editor_prefs.layout_threads : g_get_num_processors(), 0);
+	SSM(sci, SCI_SETLAYOUTCACHE, CLAMP(editor_prefs.layout_cache, SC_CACHE_NONE, SC_CACHE_DOCUMENT), 0);
+	SSM(sci, SCI_SETPOSITIONCACHE, (uptr_t) MAX(editor_prefs.position_cache, 0), 0);
+	/* only measure the visible part of huge unwrapped lines */
+	scintilla_set_long_line_layout_length(sci, (gintptr) MAX(editor_prefs.long_line_layout_size, 0) * 1024);
+
+	editor_set_undo_memory_limit(editor);
+
+	/* not yet created for a new document, see notebook_new_tab() */
+	if (editor->document->priv->minimap)
+		geany_minimap_set_width(GEANY_MINIMAP(editor->document->priv->minimap), editor_prefs.minimap_width);
+}
+
+
+/* Spills the oldest undo text of the document to disk past the configured limit, so that
+ * editing huge files doesn't double their memory use. */
+void editor_set_undo_memory_limit(GeanyEditor *editor)
+{
+	scintilla_set_undo_memory_limit(editor->sci, (gsize) MAX(editor_prefs.undo_memory_limit, 0) * 1024);
 }
 
 
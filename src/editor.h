@@ -142,6 +142,14 @@ typedef struct GeanyEditorPrefs
 	gboolean	show_line_endings_only_when_differ;
 	gboolean	change_history_markers;
 	gboolean	change_history_indicators;
+	gint		layout_threads;	/* hidden pref, 0 for one per processor */
+	gint		layout_cache;	/* hidden pref, SC_CACHE_* */
+	gint		position_cache;	/* hidden pref, number of measured text runs to cache */
+	gint		long_line_layout_size;	/* hidden pref, in KiB, 0 to always lay out whole lines */
+	gint		idle_styling_size;	/* hidden pref, in KiB, 0 to always style synchronously */
+	gint		parallel_lexing_size;	/* hidden pref, in KiB, 0 to never lex in parallel */
+	gint		undo_memory_limit;	/* hidden pref, in KiB, 0 for no limit */
+	gint		minimap_width;	/* hidden pref, in pixels, 0 to hide the document overview */
 }
 GeanyEditorPrefs;
 
@@ -303,6 +311,8 @@ void editor_set_font(GeanyEditor *editor, const gchar *font);
 
 void editor_indicator_clear_errors(GeanyEditor *editor);
 
+void editor_indicator_set_on_ranges(GeanyEditor *editor, gint indic, const gintptr *ranges, gsize n_ranges);
+
 void editor_fold_all(GeanyEditor *editor);
 
 void editor_unfold_all(GeanyEditor *editor);
@@ -329,6 +339,8 @@ void editor_set_indentation_guides(GeanyEditor *editor);
 
 void editor_apply_update_prefs(GeanyEditor *editor);
 
+void editor_set_undo_memory_limit(GeanyEditor *editor);
+
 void editor_toggle_fold(GeanyEditor *editor, gint line, gint modifiers);
 
 #endif /* GEANY_PRIVATE */
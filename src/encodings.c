@@ -920,9 +920,39 @@ typedef struct
 	gsize		 size;	/* actual data size */
 	gchar		*enc;
 	gboolean	 bom;
+	gboolean	 scanned;	/* whether scan matches data */
+	GeanyTextScan scan;
 } BufferData;
 
 
+/* Sets data, invalidating the scan of the previous data. */
+static void buffer_set_data(BufferData *buffer, gchar *data)
+{
+	SETPTR(buffer->data, data);
+	buffer->scanned = FALSE;
+}
+
+
+static const GeanyTextScan *buffer_get_scan(BufferData *buffer)
+{
+	if (! buffer->scanned)
+	{
+		utils_scan_text(buffer->data, buffer->size, &buffer->scan);
+		buffer->scanned = TRUE;
+	}
+	return &buffer->scan;
+}
+
+
+/* Like g_utf8_validate(), but keeps the results of the scan for later. */
+static gboolean buffer_is_utf8(BufferData *buffer)
+{
+	const GeanyTextScan *scan = buffer_get_scan(buffer);
+
+	return scan->valid_len == buffer->size && scan->nul_pos == buffer->size;
+}
+
+
 /* convert data with the specified encoding */
 static gboolean
 handle_forced_encoding(BufferData *buffer, const gchar *forced_enc, GError **error)
@@ -931,7 +961,7 @@ handle_forced_encoding(BufferData *buffer, const gchar *forced_enc, GError **err
 
 	if (utils_str_equal(forced_enc, "UTF-8"))
 	{
-		if (! g_utf8_validate(buffer->data, buffer->size, NULL))
+		if (! buffer_is_utf8(buffer))
 		{
 			g_set_error(error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
 					_("Data contains NULs or is not valid UTF-8"));
@@ -948,7 +978,7 @@ handle_forced_encoding(BufferData *buffer, const gchar *forced_enc, GError **err
 		}
 		else
 		{
-			SETPTR(buffer->data, converted_text);
+			buffer_set_data(buffer, converted_text);
 		}
 	}
 	enc_idx = encodings_scan_unicode_bom(buffer->data, buffer->size, NULL);
@@ -980,7 +1010,7 @@ handle_encoding(BufferData *buffer, GeanyEncodingIndex enc_idx, GError **error)
 
 			if (enc_idx == GEANY_ENCODING_UTF_8)
 			{
-				if (! g_utf8_validate(buffer->data, buffer->size, NULL))
+				if (! buffer_is_utf8(buffer))
 				{
 					/* this is not actually valid UTF-8 */
 					SETPTR(buffer->enc, NULL);
@@ -993,7 +1023,7 @@ handle_encoding(BufferData *buffer, GeanyEncodingIndex enc_idx, GError **error)
 										buffer->data, buffer->size, buffer->enc, FALSE, &buffer->size, NULL);
 				if (converted_text != NULL)
 				{
-					SETPTR(buffer->data, converted_text);
+					buffer_set_data(buffer, converted_text);
 				}
 				else
 				{
@@ -1011,7 +1041,7 @@ handle_encoding(BufferData *buffer, GeanyEncodingIndex enc_idx, GError **error)
 
 			/* try UTF-8 first */
 			if (encodings_get_idx_from_charset(regex_charset) == GEANY_ENCODING_UTF_8 &&
-				g_utf8_validate(buffer->data, buffer->size, NULL))
+				buffer_is_utf8(buffer))
 			{
 				buffer->enc = g_strdup("UTF-8");
 			}
@@ -1026,7 +1056,7 @@ handle_encoding(BufferData *buffer, GeanyEncodingIndex enc_idx, GError **error)
 					g_free(regex_charset);
 					return FALSE;
 				}
-				SETPTR(buffer->data, converted_text);
+				buffer_set_data(buffer, converted_text);
 			}
 			g_free(regex_charset);
 		}
@@ -1048,6 +1078,12 @@ handle_bom(BufferData *buffer)
 	/* overwrite the BOM with the remainder of the file contents, plus the NULL terminator. */
 	memmove(buffer->data, buffer->data + bom_len, buffer->size + 1);
 	buffer->data = g_realloc(buffer->data, buffer->size + 1);
+	/* the BOM is valid UTF-8 without line endings, so the scan only moves */
+	if (buffer->scanned)
+	{
+		buffer->scan.valid_len -= bom_len;
+		buffer->scan.nul_pos -= bom_len;
+	}
 }
 
 
@@ -1081,6 +1117,8 @@ static gboolean handle_buffer(BufferData *buffer, const gchar *forced_enc, GErro
 
 	if (buffer->bom)
 		handle_bom(buffer);
+	/* UTF-8 data has been scanned while validating it, anything else is scanned here */
+	buffer_get_scan(buffer);
 	return TRUE;
 }
 
@@ -1103,6 +1141,23 @@ static gboolean handle_buffer(BufferData *buffer, const gchar *forced_enc, GErro
 GEANY_EXPORT_SYMBOL
 gboolean encodings_convert_to_utf8_auto(gchar **buf, gsize *size, const gchar *forced_enc,
 		gchar **used_encoding, gboolean *has_bom, gboolean *has_nuls, GError **error)
+{
+	GeanyTextScan scan;
+
+	if (! encodings_convert_to_utf8_auto_scan(buf, size, forced_enc, used_encoding, has_bom,
+				&scan, error))
+		return FALSE;
+
+	if (has_nuls)
+		*has_nuls = scan.nul_pos != *size;
+	return TRUE;
+}
+
+
+/* Like encodings_convert_to_utf8_auto(), but also returns the line endings and NULs of
+ * the converted data in scan. Data that was already UTF-8 is only read once for all of it. */
+gboolean encodings_convert_to_utf8_auto_scan(gchar **buf, gsize *size, const gchar *forced_enc,
+		gchar **used_encoding, gboolean *has_bom, GeanyTextScan *scan, GError **error)
 {
 	BufferData buffer;
 
@@ -1110,6 +1165,7 @@ gboolean encodings_convert_to_utf8_auto(gchar **buf, gsize *size, const gchar *f
 	buffer.size = *size;
 	buffer.enc = NULL;
 	buffer.bom = FALSE;
+	buffer.scanned = FALSE;
 
 	if (! handle_buffer(&buffer, forced_enc, error))
 		return FALSE;
@@ -1121,8 +1177,7 @@ gboolean encodings_convert_to_utf8_auto(gchar **buf, gsize *size, const gchar *f
 		g_free(buffer.enc);
 	if (has_bom)
 		*has_bom = buffer.bom;
-	if (has_nuls)
-		*has_nuls = strlen(buffer.data) != buffer.size;
+	*scan = buffer.scan;
 
 	*buf = buffer.data;
 	return TRUE;
@@ -22,6 +22,7 @@
 #define ENCODINGSPRIVATE_H
 
 #include "encodings.h"
+#include "utils.h"
 
 /* Groups of encodings */
 typedef enum
@@ -77,6 +78,10 @@ gboolean encodings_convert_to_utf8_auto(gchar **buf, gsize *size, const gchar *f
                                         gchar **used_encoding, gboolean *has_bom, gboolean *has_nuls,
                                         GError **error);
 
+gboolean encodings_convert_to_utf8_auto_scan(gchar **buf, gsize *size, const gchar *forced_enc,
+                                             gchar **used_encoding, gboolean *has_bom,
+                                             GeanyTextScan *scan, GError **error);
+
 GeanyEncodingIndex encodings_scan_unicode_bom(const gchar *string, gsize len, guint *bom_len);
 
 GeanyEncodingIndex encodings_get_idx_from_charset(const gchar *charset);
@@ -0,0 +1,509 @@
+/*
+ *      geanyminimap.c - this file is part of Geany, a fast and lightweight IDE
+ *
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * A GtkDrawingArea showing an overview of a whole Scintilla document next to it, which
+ * can be clicked or dragged to scroll the document.
+ *
+ * Each row of the overview shows one line as runs of one pixel per character in the
+ * colour of its style. When the document has more lines than fit, the whole document is
+ * shrunk to the height of the widget and each row shows a sample line of the lines it
+ * covers. Rendered rows are kept in a surface and only the rows touched by modifications
+ * are rendered again, so a frame never costs more than rendering the visible rows,
+ * whatever the size of the document.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "geanyminimap.h"
+
+#include "sciwrappers.h"
+
+#include <string.h>
+
+
+/* height in pixels of a row, which is a line or a sample of lines */
+#define ROW_HEIGHT 2
+/* number of lines a row covering several lines tries to find a non-blank one to show */
+#define SAMPLE_LINES 8
+
+
+struct _GeanyMinimapClass
+{
+	GtkDrawingAreaClass parent_class;
+};
+
+typedef struct
+{
+	ScintillaObject *sci;
+	cairo_surface_t *surface;	/* rendered rows */
+	gint surface_width;
+	gint surface_height;
+	gint n_rows;				/* rows the surface has room for */
+	gint line_count;			/* line count the rows were rendered for */
+	sptr_t doc_pointer;			/* document the rows were rendered for */
+	gint dirty_start;			/* rows to render again before painting */
+	gint dirty_end;
+	gint colours[STYLE_MAX + 1];	/* foreground colours the rows were rendered with */
+	gint back_colour;
+	gchar *styled_text;			/* buffer for SCI_GETSTYLEDTEXTFULL */
+	gsize styled_text_size;
+	gboolean dragging;
+} GeanyMinimapPrivate;
+
+struct _GeanyMinimap
+{
+	GtkDrawingArea parent;
+	GeanyMinimapPrivate *priv;
+};
+
+
+static void geany_minimap_dispose(GObject *object);
+static gboolean geany_minimap_draw(GtkWidget *widget, cairo_t *cr);
+static gboolean geany_minimap_button_press(GtkWidget *widget, GdkEventButton *event);
+static gboolean geany_minimap_button_release(GtkWidget *widget, GdkEventButton *event);
+static gboolean geany_minimap_motion_notify(GtkWidget *widget, GdkEventMotion *event);
+static gboolean geany_minimap_scroll(GtkWidget *widget, GdkEventScroll *event);
+
+G_DEFINE_TYPE(GeanyMinimap, geany_minimap, GTK_TYPE_DRAWING_AREA)
+
+
+static void geany_minimap_class_init(GeanyMinimapClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GtkWidgetClass *widget_class = GTK_WIDGET_CLASS(klass);
+
+	object_class->dispose = geany_minimap_dispose;
+	widget_class->draw = geany_minimap_draw;
+	widget_class->button_press_event = geany_minimap_button_press;
+	widget_class->button_release_event = geany_minimap_button_release;
+	widget_class->motion_notify_event = geany_minimap_motion_notify;
+	widget_class->scroll_event = geany_minimap_scroll;
+
+	g_type_class_add_private(klass, sizeof (GeanyMinimapPrivate));
+}
+
+
+static void geany_minimap_init(GeanyMinimap *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE(self,
+		GEANY_MINIMAP_TYPE, GeanyMinimapPrivate);
+
+	gtk_widget_add_events(GTK_WIDGET(self), GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
+		GDK_POINTER_MOTION_MASK | GDK_SCROLL_MASK);
+}
+
+
+static void geany_minimap_dispose(GObject *object)
+{
+	GeanyMinimapPrivate *priv = GEANY_MINIMAP(object)->priv;
+
+	g_clear_pointer(&priv->surface, cairo_surface_destroy);
+	g_clear_pointer(&priv->styled_text, g_free);
+	g_clear_object(&priv->sci);
+
+	G_OBJECT_CLASS(geany_minimap_parent_class)->dispose(object);
+}
+
+
+static gboolean is_scaled(GeanyMinimapPrivate *priv)
+{
+	return priv->line_count > priv->n_rows;
+}
+
+
+static gint first_line_of_row(GeanyMinimapPrivate *priv, gint row)
+{
+	if (! is_scaled(priv))
+		return row;
+	return (gint) ((gint64) row * priv->line_count / priv->n_rows);
+}
+
+
+static gint row_of_line(GeanyMinimapPrivate *priv, gint line)
+{
+	if (! is_scaled(priv))
+		return line;
+	return (gint) ((gint64) line * priv->n_rows / priv->line_count);
+}
+
+
+static gdouble y_of_line(GeanyMinimapPrivate *priv, gint line)
+{
+	if (! is_scaled(priv))
+		return (gdouble) line * ROW_HEIGHT;
+	return (gdouble) line * priv->n_rows / priv->line_count * ROW_HEIGHT;
+}
+
+
+static gint line_of_y(GeanyMinimapPrivate *priv, gdouble y)
+{
+	gint line;
+
+	if (! is_scaled(priv))
+		line = (gint) (y / ROW_HEIGHT);
+	else
+		line = (gint) (y / ROW_HEIGHT * priv->line_count / priv->n_rows);
+	return CLAMP(line, 0, MAX(priv->line_count - 1, 0));
+}
+
+
+/* Marks rows to render again before the next paint */
+static void set_rows_dirty(GeanyMinimapPrivate *priv, gint start, gint end)
+{
+	if (priv->dirty_start < priv->dirty_end)
+	{
+		priv->dirty_start = MIN(priv->dirty_start, start);
+		priv->dirty_end = MAX(priv->dirty_end, end);
+	}
+	else
+	{
+		priv->dirty_start = start;
+		priv->dirty_end = end;
+	}
+}
+
+
+static void invalidate_rows(GeanyMinimap *self, gint start, gint end)
+{
+	set_rows_dirty(self->priv, start, end);
+	gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+
+static void on_sci_notify(GtkWidget *widget, gint scn, SCNotification *nt, GeanyMinimap *self)
+{
+	GeanyMinimapPrivate *priv = self->priv;
+
+	if (nt->nmhdr.code == SCN_MODIFIED &&
+		(nt->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_CHANGESTYLE)))
+	{
+		gint line = sci_get_line_from_position(priv->sci, nt->position);
+
+		if (nt->linesAdded != 0)
+		{
+			/* the following lines moved, and the scale may have changed which is
+			 * checked before rendering */
+			invalidate_rows(self, row_of_line(priv, line), G_MAXINT);
+		}
+		else
+		{
+			gint end_line = (nt->modificationType & SC_MOD_CHANGESTYLE) ?
+				sci_get_line_from_position(priv->sci, nt->position + nt->length) : line;
+
+			invalidate_rows(self, row_of_line(priv, line), row_of_line(priv, end_line) + 1);
+		}
+	}
+	else if (nt->nmhdr.code == SCN_UPDATEUI && (nt->updated & SC_UPDATE_V_SCROLL))
+		gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+
+/* Checks what the rendered rows depend on besides the text and its styles */
+static void check_rendered_state(GeanyMinimap *self)
+{
+	GeanyMinimapPrivate *priv = self->priv;
+	GtkWidget *widget = GTK_WIDGET(self);
+	gint width = gtk_widget_get_allocated_width(widget);
+	gint height = gtk_widget_get_allocated_height(widget);
+	gint line_count = sci_get_line_count(priv->sci);
+	sptr_t doc_pointer = SSM(priv->sci, SCI_GETDOCPOINTER, 0, 0);
+	gint colour, i;
+
+	if (! priv->surface || priv->surface_width != width || priv->surface_height != height)
+	{
+		g_clear_pointer(&priv->surface, cairo_surface_destroy);
+		priv->surface = gdk_window_create_similar_surface(gtk_widget_get_window(widget),
+			CAIRO_CONTENT_COLOR, MAX(width, 1), MAX(height, 1));
+		priv->surface_width = width;
+		priv->surface_height = height;
+		priv->n_rows = MAX(height / ROW_HEIGHT, 1);
+		set_rows_dirty(priv, 0, G_MAXINT);
+	}
+
+	if (doc_pointer != priv->doc_pointer)
+	{
+		priv->doc_pointer = doc_pointer;
+		set_rows_dirty(priv, 0, G_MAXINT);
+	}
+
+	if (line_count != priv->line_count)
+	{
+		gboolean was_scaled = is_scaled(priv);
+
+		/* when shrunk, every row covers other lines */
+		priv->line_count = line_count;
+		if (was_scaled || is_scaled(priv))
+			set_rows_dirty(priv, 0, G_MAXINT);
+	}
+
+	colour = SSM(priv->sci, SCI_STYLEGETBACK, STYLE_DEFAULT, 0);
+	if (colour != priv->back_colour)
+	{
+		priv->back_colour = colour;
+		set_rows_dirty(priv, 0, G_MAXINT);
+	}
+	for (i = 0; i <= STYLE_MAX; i++)
+	{
+		colour = SSM(priv->sci, SCI_STYLEGETFORE, i, 0);
+		if (colour != priv->colours[i])
+		{
+			priv->colours[i] = colour;
+			set_rows_dirty(priv, 0, G_MAXINT);
+		}
+	}
+}
+
+
+static void set_source_sci_colour(cairo_t *cr, gint colour, gdouble alpha)
+{
+	cairo_set_source_rgba(cr, (colour & 0xff) / 255.0, ((colour >> 8) & 0xff) / 255.0,
+		((colour >> 16) & 0xff) / 255.0, alpha);
+}
+
+
+/* Picks the line to show in row, the first non-blank one if the row covers several */
+static gint get_row_line(GeanyMinimapPrivate *priv, gint row)
+{
+	gint line = first_line_of_row(priv, row);
+	gint next = MIN(first_line_of_row(priv, row + 1), line + SAMPLE_LINES);
+	gint i;
+
+	for (i = line; i < next; i++)
+	{
+		if (SSM(priv->sci, SCI_GETLINEINDENTPOSITION, i, 0) <
+			SSM(priv->sci, SCI_GETLINEENDPOSITION, i, 0))
+			return i;
+	}
+	return line;
+}
+
+
+/* Draws the styles runs of the line shown in row, one pixel per character */
+static void render_row(GeanyMinimap *self, cairo_t *cr, gint row, gint tab_width)
+{
+	GeanyMinimapPrivate *priv = self->priv;
+	gint line = get_row_line(priv, row);
+	gint width = priv->surface_width;
+	struct Sci_TextRangeFull tr;
+	gsize len, i;
+	gint column = 0, run_start = -1;
+	guchar run_style = 0;
+
+	tr.chrg.cpMin = sci_get_position_from_line(priv->sci, line);
+	tr.chrg.cpMax = sci_get_line_end_position(priv->sci, line);
+	/* no need for more than a character per column */
+	tr.chrg.cpMax = MIN(tr.chrg.cpMax, tr.chrg.cpMin + (Sci_Position) width * 4);
+	len = tr.chrg.cpMax - tr.chrg.cpMin;
+	if (priv->styled_text_size < len * 2 + 2)
+	{
+		priv->styled_text_size = len * 2 + 2;
+		priv->styled_text = g_realloc(priv->styled_text, priv->styled_text_size);
+	}
+	tr.lpstrText = priv->styled_text;
+	SSM(priv->sci, SCI_GETSTYLEDTEXTFULL, 0, (sptr_t) &tr);
+
+	for (i = 0; i < len && column < width; i++)
+	{
+		guchar ch = tr.lpstrText[i * 2];
+		guchar style = tr.lpstrText[i * 2 + 1];
+		gboolean blank = (ch == ' ' || ch == '\t');
+
+		if ((ch & 0xc0) == 0x80)
+			continue;	/* UTF-8 continuation byte */
+
+		if (run_start >= 0 && (blank || style != run_style))
+		{
+			set_source_sci_colour(cr, priv->colours[run_style], 0.7);
+			cairo_rectangle(cr, run_start, row * ROW_HEIGHT, column - run_start, ROW_HEIGHT - 1);
+			cairo_fill(cr);
+			run_start = -1;
+		}
+		if (ch == '\t')
+			column = (column / tab_width + 1) * tab_width;
+		else
+		{
+			if (! blank && run_start < 0)
+			{
+				run_start = column;
+				run_style = style;
+			}
+			column++;
+		}
+	}
+	if (run_start >= 0)
+	{
+		set_source_sci_colour(cr, priv->colours[run_style], 0.7);
+		cairo_rectangle(cr, run_start, row * ROW_HEIGHT, MIN(column, width) - run_start,
+			ROW_HEIGHT - 1);
+		cairo_fill(cr);
+	}
+}
+
+
+static void render_dirty_rows(GeanyMinimap *self)
+{
+	GeanyMinimapPrivate *priv = self->priv;
+	gint start = MAX(priv->dirty_start, 0);
+	gint end = MIN(priv->dirty_end, priv->n_rows);
+	gint used_rows = MIN(priv->n_rows, priv->line_count);
+	gint tab_width = MAX(SSM(priv->sci, SCI_GETTABWIDTH, 0, 0), 1);
+	cairo_t *cr;
+	gint row;
+
+	priv->dirty_start = priv->dirty_end = 0;
+	if (start >= end)
+		return;
+
+	cr = cairo_create(priv->surface);
+	cairo_rectangle(cr, 0, start * ROW_HEIGHT, priv->surface_width, (end - start) * ROW_HEIGHT);
+	/* the last row may not be a full one */
+	if (end == priv->n_rows)
+		cairo_rectangle(cr, 0, end * ROW_HEIGHT, priv->surface_width, ROW_HEIGHT);
+	set_source_sci_colour(cr, priv->back_colour, 1.0);
+	cairo_fill(cr);
+
+	for (row = start; row < MIN(end, used_rows); row++)
+		render_row(self, cr, row, tab_width);
+	cairo_destroy(cr);
+}
+
+
+static gboolean geany_minimap_draw(GtkWidget *widget, cairo_t *cr)
+{
+	GeanyMinimap *self = GEANY_MINIMAP(widget);
+	GeanyMinimapPrivate *priv = self->priv;
+	gint first, last;
+	gdouble y1, y2;
+
+	check_rendered_state(self);
+	render_dirty_rows(self);
+
+	cairo_set_source_surface(cr, priv->surface, 0, 0);
+	cairo_paint(cr);
+
+	/* shade the lines visible in the editor */
+	first = SSM(priv->sci, SCI_GETFIRSTVISIBLELINE, 0, 0);
+	last = first + SSM(priv->sci, SCI_LINESONSCREEN, 0, 0);
+	first = SSM(priv->sci, SCI_DOCLINEFROMVISIBLE, first, 0);
+	last = SSM(priv->sci, SCI_DOCLINEFROMVISIBLE, last, 0);
+	y1 = y_of_line(priv, first);
+	y2 = MAX(y_of_line(priv, last + 1), y1 + ROW_HEIGHT);
+	set_source_sci_colour(cr, priv->colours[STYLE_DEFAULT], 0.15);
+	cairo_rectangle(cr, 0, y1, priv->surface_width, y2 - y1);
+	cairo_fill(cr);
+
+	return FALSE;
+}
+
+
+/* Scrolls the editor to show the line at y in the middle */
+static void scroll_to_y(GeanyMinimap *self, gdouble y)
+{
+	GeanyMinimapPrivate *priv = self->priv;
+	gint line = line_of_y(priv, y);
+	gint visible = SSM(priv->sci, SCI_VISIBLEFROMDOCLINE, line, 0);
+	gint lines_on_screen = SSM(priv->sci, SCI_LINESONSCREEN, 0, 0);
+
+	SSM(priv->sci, SCI_SETFIRSTVISIBLELINE, MAX(visible - lines_on_screen / 2, 0), 0);
+}
+
+
+static gboolean geany_minimap_button_press(GtkWidget *widget, GdkEventButton *event)
+{
+	GeanyMinimap *self = GEANY_MINIMAP(widget);
+
+	if (event->button != 1 || event->type != GDK_BUTTON_PRESS)
+		return FALSE;
+
+	self->priv->dragging = TRUE;
+	scroll_to_y(self, event->y);
+	return TRUE;
+}
+
+
+static gboolean geany_minimap_button_release(GtkWidget *widget, GdkEventButton *event)
+{
+	GeanyMinimap *self = GEANY_MINIMAP(widget);
+
+	if (event->button != 1)
+		return FALSE;
+
+	self->priv->dragging = FALSE;
+	return TRUE;
+}
+
+
+static gboolean geany_minimap_motion_notify(GtkWidget *widget, GdkEventMotion *event)
+{
+	GeanyMinimap *self = GEANY_MINIMAP(widget);
+
+	if (! self->priv->dragging)
+		return FALSE;
+
+	scroll_to_y(self, event->y);
+	return TRUE;
+}
+
+
+/* scrolls the editor like its own scrollbar would */
+static gboolean geany_minimap_scroll(GtkWidget *widget, GdkEventScroll *event)
+{
+	GeanyMinimap *self = GEANY_MINIMAP(widget);
+	gdouble dx, dy;
+	gint lines;
+
+	if (event->direction == GDK_SCROLL_UP)
+		lines = -3;
+	else if (event->direction == GDK_SCROLL_DOWN)
+		lines = 3;
+	else if (gdk_event_get_scroll_deltas((GdkEvent *) event, &dx, &dy))
+		lines = (gint) (dy * 3);
+	else
+		return FALSE;
+
+	SSM(self->priv->sci, SCI_LINESCROLL, 0, lines);
+	return TRUE;
+}
+
+
+/* Sets the width of the overview in pixels, hiding it when 0 */
+GEANY_EXPORT_SYMBOL
+void geany_minimap_set_width(GeanyMinimap *minimap, gint width)
+{
+	g_return_if_fail(IS_GEANY_MINIMAP(minimap));
+
+	gtk_widget_set_size_request(GTK_WIDGET(minimap), MAX(width, 0), -1);
+	gtk_widget_set_visible(GTK_WIDGET(minimap), width > 0);
+}
+
+
+/* Creates an overview of sci's document, which has to be packed next to sci */
+GEANY_EXPORT_SYMBOL
+GtkWidget *geany_minimap_new(ScintillaObject *sci)
+{
+	GeanyMinimap *self = g_object_new(GEANY_MINIMAP_TYPE, NULL);
+
+	self->priv->sci = g_object_ref(sci);
+	g_signal_connect_object(sci, "sci-notify", G_CALLBACK(on_sci_notify), self, 0);
+	return GTK_WIDGET(self);
+}
@@ -0,0 +1,52 @@
+/*
+ *      geanyminimap.h - this file is part of Geany, a fast and lightweight IDE
+ *
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GEANY_MINIMAP_H
+#define GEANY_MINIMAP_H 1
+
+#include "gtkcompat.h"
+#include "Scintilla.h"
+#include "ScintillaWidget.h"
+
+G_BEGIN_DECLS
+
+
+#define GEANY_MINIMAP_TYPE				(geany_minimap_get_type())
+#define GEANY_MINIMAP(obj)				(G_TYPE_CHECK_INSTANCE_CAST((obj), \
+	GEANY_MINIMAP_TYPE, GeanyMinimap))
+#define GEANY_MINIMAP_CLASS(klass)		(G_TYPE_CHECK_CLASS_CAST((klass), \
+	GEANY_MINIMAP_TYPE, GeanyMinimapClass))
+#define IS_GEANY_MINIMAP(obj)			(G_TYPE_CHECK_INSTANCE_TYPE((obj), \
+	GEANY_MINIMAP_TYPE))
+#define IS_GEANY_MINIMAP_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE((klass), \
+	GEANY_MINIMAP_TYPE))
+
+
+typedef struct _GeanyMinimap       GeanyMinimap;
+typedef struct _GeanyMinimapClass  GeanyMinimapClass;
+
+GType			geany_minimap_get_type			(void);
+GtkWidget*		geany_minimap_new				(ScintillaObject *sci);
+void			geany_minimap_set_width			(GeanyMinimap *minimap, gint width);
+
+
+G_END_DECLS
+
+#endif /* GEANY_MINIMAP_H */
@@ -318,6 +318,22 @@ static void init_pref_groups(void)
 		"indent_hard_tab_width", 8);
 	stash_group_add_integer(group, &editor_prefs.ime_interaction,
 		"editor_ime_interaction", SC_IME_WINDOWED);
+	stash_group_add_integer(group, &editor_prefs.layout_threads,
+		"layout_threads", 0);
+	stash_group_add_integer(group, &editor_prefs.layout_cache,
+		"layout_cache", SC_CACHE_PAGE);
+	stash_group_add_integer(group, &editor_prefs.position_cache,
+		"position_cache", 4096);
+	stash_group_add_integer(group, &editor_prefs.long_line_layout_size,
+		"long_line_layout_size", 64);
+	stash_group_add_integer(group, &editor_prefs.idle_styling_size,
+		"idle_styling_size", 1024);
+	stash_group_add_integer(group, &editor_prefs.parallel_lexing_size,
+		"parallel_lexing_size", 1024);
+	stash_group_add_integer(group, &editor_prefs.undo_memory_limit,
+		"undo_memory_limit", 262144);
+	stash_group_add_integer(group, &editor_prefs.minimap_width,
+		"minimap_width", 0);
 
 	group = stash_group_new(PACKAGE);
 	configuration_add_various_pref_group(group, "files");
@@ -340,6 +356,14 @@ static void init_pref_groups(void)
 		"extract_filetype_regex", GEANY_DEFAULT_FILETYPE_REGEX);
 	stash_group_add_boolean(group, &ui_prefs.allow_always_save,
 		"allow_always_save", FALSE);
+	stash_group_add_integer(group, &file_prefs.symbols_parse_max_size,
+		"symbols_parse_max_size", 0);
+	stash_group_add_integer(group, &file_prefs.symbols_parse_timeout,
+		"symbols_parse_timeout", 0);
+	stash_group_add_integer(group, &file_prefs.background_load_size,
+		"background_load_size", 16384);
+	stash_group_add_integer(group, &file_prefs.huge_file_size,
+		"huge_file_size", 262144);
 
 	group = stash_group_new(PACKAGE);
 	configuration_add_various_pref_group(group, "search");
@@ -40,6 +40,8 @@
 #endif
 
 static GString *log_buffer = NULL;
+/* Guards log_buffer, as messages may be logged by worker threads like the file loading one */
+static GMutex log_mutex;
 static GtkTextBuffer *dialog_textbuffer = NULL;
 
 enum
@@ -55,7 +57,9 @@ static void update_dialog(void)
 		GtkTextMark *mark;
 		GtkTextView *textview = g_object_get_data(G_OBJECT(dialog_textbuffer), "textview");
 
+		g_mutex_lock(&log_mutex);
 		gtk_text_buffer_set_text(dialog_textbuffer, log_buffer->str, log_buffer->len);
+		g_mutex_unlock(&log_mutex);
 		/* scroll to the end of the messages as this might be most interesting */
 		mark = gtk_text_buffer_get_insert(dialog_textbuffer);
 		gtk_text_view_scroll_to_mark(textview, mark, 0.0, FALSE, 0.0, 0.0);
@@ -63,6 +67,28 @@ static void update_dialog(void)
 }
 
 
+static gboolean update_dialog_idle(gpointer data)
+{
+	update_dialog();
+	return G_SOURCE_REMOVE;
+}
+
+
+/* Adds text to the log. The dialog is only updated by the main thread, other threads leave
+ * it to an idle callback. */
+static void append_to_log(const gchar *text)
+{
+	g_mutex_lock(&log_mutex);
+	g_string_append(log_buffer, text);
+	g_mutex_unlock(&log_mutex);
+
+	if (g_main_context_is_owner(g_main_context_default()))
+		update_dialog();
+	else
+		g_idle_add(update_dialog_idle, NULL);
+}
+
+
 /* Geany's main debug/log function, declared in geany.h */
 void geany_debug(gchar const *format, ...)
 {
@@ -77,10 +103,7 @@ static void handler_print(const gchar *msg)
 {
 	printf("%s", msg);
 	if (G_LIKELY(log_buffer != NULL))
-	{
-		g_string_append_printf(log_buffer, "%s", msg);
-		update_dialog();
-	}
+		append_to_log(msg);
 }
 
 
@@ -88,10 +111,7 @@ static void handler_printerr(const gchar *msg)
 {
 	fprintf(stderr, "%s", msg);
 	if (G_LIKELY(log_buffer != NULL))
-	{
-		g_string_append_printf(log_buffer, "%s", msg);
-		update_dialog();
-	}
+		append_to_log(msg);
 }
 
 
@@ -118,7 +138,7 @@ static const gchar *get_log_prefix(GLogLevelFlags log_level)
 
 static void handler_log(const gchar *domain, GLogLevelFlags level, const gchar *msg, gpointer data)
 {
-	gchar *time_str;
+	gchar *time_str, *text;
 
 	if (G_LIKELY(app != NULL && app->debug_mode) ||
 		! ((G_LOG_LEVEL_DEBUG | G_LOG_LEVEL_INFO | G_LOG_LEVEL_MESSAGE) & level))
@@ -139,12 +159,11 @@ static void handler_log(const gchar *domain, GLogLevelFlags level, const gchar *
 
 	time_str = utils_get_current_time_string(TRUE);
 
-	g_string_append_printf(log_buffer, "%s: %s %s: %s\n", time_str, domain,
-		get_log_prefix(level), msg);
+	text = g_strdup_printf("%s: %s %s: %s\n", time_str, domain, get_log_prefix(level), msg);
+	append_to_log(text);
 
+	g_free(text);
 	g_free(time_str);
-
-	update_dialog();
 }
 
 
@@ -168,7 +187,9 @@ static void on_dialog_response(GtkDialog *dialog, gint response, gpointer user_d
 		gtk_text_buffer_get_end_iter(dialog_textbuffer, &end_iter);
 		gtk_text_buffer_delete(dialog_textbuffer, &start_iter, &end_iter);
 
+		g_mutex_lock(&log_mutex);
 		g_string_erase(log_buffer, 0, -1);
+		g_mutex_unlock(&log_mutex);
 	}
 	else
 	{
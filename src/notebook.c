@@ -30,6 +30,7 @@
 
 #include "callbacks.h"
 #include "documentprivate.h"
+#include "geanyminimap.h"
 #include "geanyobject.h"
 #include "keybindings.h"
 #include "main.h"
@@ -711,10 +712,17 @@ gint notebook_new_tab(GeanyDocument *this)
 
 	g_return_val_if_fail(this != NULL, -1);
 
-	/* page is packed into a vbox so we can stack infobars above it */
+	/* page is packed into a vbox so we can stack infobars above it, and next to its
+	 * overview in an hbox */
 	vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
 	page = GTK_WIDGET(this->editor->sci);
-	gtk_box_pack_start(GTK_BOX(vbox), page, TRUE, TRUE, 0);
+	gtk_box_pack_start(GTK_BOX(hbox), page, TRUE, TRUE, 0);
+	this->priv->minimap = geany_minimap_new(this->editor->sci);
+	geany_minimap_set_width(GEANY_MINIMAP(this->priv->minimap), editor_prefs.minimap_width);
+	gtk_box_pack_start(GTK_BOX(hbox), this->priv->minimap, FALSE, FALSE, 0);
+	gtk_widget_show(hbox);
+	gtk_box_pack_start(GTK_BOX(vbox), hbox, TRUE, TRUE, 0);
 
 	this->priv->tab_label = gtk_label_new(NULL);
 
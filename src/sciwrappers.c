@@ -45,6 +45,7 @@
 
 #ifndef NDEBUG
 
+GEANY_EXPORT_SYMBOL
 sptr_t sci_send_message_internal (const gchar *file, guint line, ScintillaObject *sci,
 	guint msg, uptr_t wparam, sptr_t lparam)
 {
@@ -256,6 +257,7 @@ void sci_set_visible_white_spaces(ScintillaObject *sci, gboolean set)
 }
 
 
+GEANY_EXPORT_SYMBOL
 void sci_set_lines_wrapped(ScintillaObject *sci, gboolean set)
 {
 	if (set)
@@ -519,6 +521,13 @@ gint sci_get_position_from_col(ScintillaObject *sci, gint line, gint col)
 }
 
 
+/* Counts the characters between start and end, which is quick within a line */
+gint sci_count_characters(ScintillaObject *sci, gint start, gint end)
+{
+	return (gint) SSM(sci, SCI_COUNTCHARACTERS, (uptr_t) start, end);
+}
+
+
 /** Gets the position for the start of @a line.
  * @param sci Scintilla widget.
  * @param line Line.
@@ -700,6 +709,7 @@ gint sci_get_lexer(ScintillaObject *sci)
 }
 
 
+GEANY_EXPORT_SYMBOL
 void sci_set_lexer(ScintillaObject *sci, guint lexer_id)
 {
 	gint old = sci_get_lexer(sci);
@@ -721,6 +731,20 @@ void sci_set_lexer(ScintillaObject *sci, guint lexer_id)
 }
 
 
+static void *create_lexer(const char *name)
+{
+	return CreateLexer(name);
+}
+
+
+/* Lexes big ranges of the document in independent chunks on up to @a threads threads.
+ * Only suitable for lexers keeping all their state in the document. */
+void sci_set_parallel_lexing(ScintillaObject *sci, guint threads)
+{
+	scintilla_set_parallel_lexing(sci, threads, create_lexer);
+}
+
+
 /** Gets line length.
  * @param sci Scintilla widget.
  * @param line Line number.
@@ -902,6 +926,7 @@ gboolean sci_get_fold_expanded(ScintillaObject *sci, gint line)
 }
 
 
+GEANY_EXPORT_SYMBOL
 void sci_colourise(ScintillaObject *sci, gint start, gint end)
 {
 	SSM(sci, SCI_COLOURISE, (uptr_t) start, end);
@@ -1112,6 +1137,7 @@ gint sci_get_style_at(ScintillaObject *sci, gint position)
 }
 
 
+GEANY_EXPORT_SYMBOL
 void sci_set_codepage(ScintillaObject *sci, gint cp)
 {
 	g_return_if_fail(cp == 0 || cp == SC_CP_UTF8);
@@ -1215,6 +1241,7 @@ gint sci_replace_target(ScintillaObject *sci, const gchar *text, gboolean regex)
 }
 
 
+GEANY_EXPORT_SYMBOL
 void sci_set_keywords(ScintillaObject *sci, guint k, const gchar *text)
 {
 	SSM(sci, SCI_SETKEYWORDS, k, (sptr_t) text);
@@ -1295,6 +1322,7 @@ void sci_indicator_set(ScintillaObject *sci, gint indic)
 }
 
 
+GEANY_EXPORT_SYMBOL
 void sci_indicator_fill(ScintillaObject *sci, gint pos, gint len)
 {
 	SSM(sci, SCI_INDICATORFILLRANGE, (uptr_t) pos, len);
@@ -139,6 +139,7 @@ gint				sci_marker_next				(ScintillaObject *sci, gint line, gint marker_mask, g
 gint				sci_marker_previous			(ScintillaObject *sci, gint line, gint marker_mask, gboolean wrap);
 
 gint 				sci_get_position_from_col (ScintillaObject *sci, gint line, gint col);
+gint				sci_count_characters		(ScintillaObject *sci, gint start, gint end);
 void 				sci_set_current_line		(ScintillaObject *sci, gint line);
 gint 				sci_get_cursor_virtual_space(ScintillaObject *sci);
 
@@ -185,6 +186,7 @@ void				sci_line_duplicate			(ScintillaObject *sci);
 
 void				sci_set_keywords			(ScintillaObject *sci, guint k, const gchar *text);
 void				sci_set_lexer				(ScintillaObject *sci, guint lexer_id);
+void				sci_set_parallel_lexing		(ScintillaObject *sci, guint threads);
 void				sci_set_readonly			(ScintillaObject *sci, gboolean readonly);
 
 gint				sci_get_lines_selected		(ScintillaObject *sci);
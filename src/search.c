@@ -158,6 +158,9 @@ static gchar **search_get_argv(const gchar **argv_prefix, const gchar *dir);
 
 static GRegex *compile_regex(const gchar *str, GeanyFindFlags sflags);
 
+static gint find_text_regex(ScintillaObject *sci, GRegex *regex, GeanyFindFlags flags,
+		struct Sci_TextToFind *ttf, GeanyMatchInfo **match_);
+
 
 static void
 on_find_replace_checkbutton_toggled(GtkToggleButton *togglebutton, gpointer user_data);
@@ -1264,6 +1267,7 @@ static GeanyMatchInfo *match_info_new(GeanyFindFlags flags, gint start, gint end
 	return info;
 }
 
+GEANY_EXPORT_SYMBOL
 void geany_match_info_free(GeanyMatchInfo *info)
 {
 	g_free(info->match_text);
@@ -1282,11 +1286,22 @@ static GSList *find_range(ScintillaObject *sci, GeanyFindFlags flags, struct Sci
 	GSList *matches = NULL;
 	GeanyMatchInfo *info;
 
+	GRegex *regex = NULL;
+
 	g_return_val_if_fail(sci != NULL && ttf->lpstrText != NULL, NULL);
 	if (! *ttf->lpstrText)
 		return NULL;
 
-	while (search_find_text(sci, flags, ttf, &info) != -1)
+	/* compile the regex only once for all matches */
+	if (flags & GEANY_FIND_REGEXP)
+	{
+		regex = compile_regex(ttf->lpstrText, flags);
+		if (!regex)
+			return NULL;
+	}
+
+	while ((regex ? find_text_regex(sci, regex, flags, ttf, &info) :
+		search_find_text(sci, flags, ttf, &info)) != -1)
 	{
 		if (ttf->chrgText.cpMax > ttf->chrg.cpMax)
 		{
@@ -1305,6 +1320,8 @@ static GSList *find_range(ScintillaObject *sci, GeanyFindFlags flags, struct Sci
 			ttf->chrg.cpMin ++;
 	}
 
+	if (regex)
+		g_regex_unref(regex);
 	return g_slist_reverse(matches);
 }
 
@@ -1316,6 +1333,7 @@ gint search_mark_all(GeanyDocument *doc, const gchar *search_text, GeanyFindFlag
 	gint count = 0;
 	struct Sci_TextToFind ttf;
 	GSList *match, *matches;
+	GArray *ranges;
 
 	g_return_val_if_fail(DOC_VALID(doc), 0);
 
@@ -1330,18 +1348,29 @@ gint search_mark_all(GeanyDocument *doc, const gchar *search_text, GeanyFindFlag
 	ttf.lpstrText = (gchar *)search_text;
 
 	matches = find_range(doc->editor->sci, flags, &ttf);
+	/* collect the (start, end) pairs to set the indicator on all matches at once,
+	 * setting it per match gets very slow with many matches */
+	ranges = g_array_new(FALSE, FALSE, sizeof(gintptr));
 	foreach_slist (match, matches)
 	{
 		GeanyMatchInfo *info = match->data;
 
 		if (info->end != info->start)
-			editor_indicator_set_on_range(doc->editor, GEANY_INDICATOR_SEARCH, info->start, info->end);
+		{
+			gintptr range[2] = { info->start, info->end };
+
+			g_array_append_vals(ranges, range, 2);
+		}
 		count++;
 
 		geany_match_info_free(info);
 	}
 	g_slist_free(matches);
 
+	editor_indicator_set_on_ranges(doc->editor, GEANY_INDICATOR_SEARCH,
+		(const gintptr *) ranges->data, ranges->len / 2);
+	g_array_free(ranges, TRUE);
+
 	return count;
 }
 
@@ -2035,10 +2064,194 @@ static gchar *get_regex_match_string(const gchar *text, const GeanyMatchInfo *ma
 }
 
 
+/* Skips the character class starting at p.
+ * Returns the position after its closing ']' or NULL if it is not terminated. */
+static const gchar *skip_regex_class(const gchar *p)
+{
+	p++;
+	if (*p == '^')
+		p++;
+	if (*p == ']')
+		p++;
+	while (*p && *p != ']')
+	{
+		if (*p == '\\' && p[1])
+			p++;
+		else if (*p == '[' && p[1] == ':')
+		{
+			const gchar *end = strstr(p + 2, ":]");
+
+			if (! end)
+				return NULL;
+			p = end + 1;
+		}
+		p++;
+	}
+	return *p ? p + 1 : NULL;
+}
+
+
+static void commit_literal_run(GString *run, GString *best)
+{
+	if (run->len > best->len)
+		g_string_assign(best, run->str);
+	g_string_truncate(run, 0);
+}
+
+
+/* Finds a run of characters every match of the regex must contain, so that lines not
+ * containing it can be skipped without running the regex.
+ * Only ASCII characters outside groups are collected, and any construct not understood
+ * here makes us give up, so a literal is only returned when it is really required.
+ * For caseless regexes, 'k' and 's' are left out as they also match non-ASCII characters.
+ * Returns NULL if there is no such literal. */
+GEANY_EXPORT_SYMBOL
+gchar *search_get_regex_required_literal(GRegex *regex)
+{
+	const gchar *p = g_regex_get_pattern(regex);
+	gboolean caseless = g_regex_get_compile_flags(regex) & G_REGEX_CASELESS;
+	GString *run, *best;
+	gint depth = 0;
+
+	if (g_regex_get_compile_flags(regex) & G_REGEX_EXTENDED)
+		return NULL;
+
+	run = g_string_new(NULL);
+	best = g_string_new(NULL);
+	while (*p)
+	{
+		gchar c = *p;
+
+		if (depth > 0)
+		{
+			if (c == '[')
+			{
+				p = skip_regex_class(p);
+				if (! p)
+					goto giveup;
+				continue;
+			}
+			if (c == '\\' && p[1])
+				p++;
+			else if (c == '(')
+				depth++;
+			else if (c == ')')
+				depth--;
+			p++;
+			continue;
+		}
+
+		switch (c)
+		{
+			case '|':
+			case ')':
+				goto giveup;
+			case '(':
+				/* options like (?i) or (?x) change how the rest is matched */
+				if (p[1] == '?' && (p[2] == '\0' || ! strchr(":=!<>P'", p[2])))
+					goto giveup;
+				commit_literal_run(run, best);
+				depth++;
+				break;
+			case '[':
+				commit_literal_run(run, best);
+				p = skip_regex_class(p);
+				if (! p)
+					goto giveup;
+				continue;
+			case '?':
+			case '*':
+			case '{':
+				/* the previous character is optional */
+				if (run->len > 0)
+					g_string_truncate(run, run->len - 1);
+				commit_literal_run(run, best);
+				if (c == '{')
+				{
+					p = strchr(p, '}');
+					if (! p)
+						goto giveup;
+				}
+				break;
+			case '+':
+			case '.':
+			case '^':
+			case '$':
+				commit_literal_run(run, best);
+				break;
+			case '\\':
+				c = p[1];
+				if (c == '\0')
+					goto giveup;
+				if (g_ascii_isalnum(c))
+				{
+					/* give up on escapes followed by more than one character, like \x41 or \p{L} */
+					if (! strchr("dDwWsSbBAzZGhHvVRXntrfea", c))
+						goto giveup;
+					commit_literal_run(run, best);
+				}
+				else if ((guchar) c >= 0x80 || c < ' ')
+					commit_literal_run(run, best);
+				else
+					g_string_append_c(run, c);
+				p++;
+				break;
+			default:
+				if ((guchar) c >= 0x80 || (caseless && strchr("kKsS", c)))
+					commit_literal_run(run, best);
+				else
+					g_string_append_c(run, c);
+				break;
+		}
+		p++;
+	}
+	commit_literal_run(run, best);
+	g_string_free(run, TRUE);
+	if (best->len > 0)
+		return g_string_free(best, FALSE);
+	g_string_free(best, TRUE);
+	return NULL;
+
+giveup:
+	g_string_free(run, TRUE);
+	g_string_free(best, TRUE);
+	return NULL;
+}
+
+
+/* Like memmem(), ignoring ASCII case if caseless is set */
+static const gchar *find_literal(const gchar *text, gsize len, const gchar *literal, gsize literal_len,
+		gboolean caseless)
+{
+	const gchar *p, *last;
+	gchar first;
+
+	if (literal_len > len)
+		return NULL;
+
+	last = text + len - literal_len;
+	first = caseless ? g_ascii_tolower(literal[0]) : literal[0];
+	for (p = text; p <= last; p++)
+	{
+		if (! caseless)
+		{
+			p = memchr(p, first, last - p + 1);
+			if (! p)
+				return NULL;
+			if (memcmp(p, literal, literal_len) == 0)
+				return p;
+		}
+		else if (g_ascii_tolower(*p) == first && g_ascii_strncasecmp(p, literal, literal_len) == 0)
+			return p;
+	}
+	return NULL;
+}
+
+
 static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean multiline, GeanyMatchInfo *match)
 {
 	const gchar *text;
-	GMatchInfo *minfo;
+	GMatchInfo *minfo = NULL;
 	guint document_length;
 	gint ret = -1;
 	gint offset = 0;
@@ -2049,41 +2262,59 @@ static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean
 
 	g_return_val_if_fail(pos <= document_length, -1);
 
+	/* Warning: any SCI calls will invalidate 'text' after calling SCI_GETCHARACTERPOINTER,
+	 * except for queries like the line positions used below */
+	text = (void*)SSM(sci, SCI_GETCHARACTERPOINTER, 0, 0);
 	if (multiline)
 	{
-		/* Warning: any SCI calls will invalidate 'text' after calling SCI_GETCHARACTERPOINTER */
-		text = (void*)SSM(sci, SCI_GETCHARACTERPOINTER, 0, 0);
 		g_regex_match_full(regex, text, -1, pos, 0, &minfo, NULL);
 	}
 	else /* single-line mode, manually match against each line */
 	{
 		gint line = sci_get_line_from_position(sci, pos);
+		gint line_count = sci_get_line_count(sci);
+		gchar *literal = search_get_regex_required_literal(regex);
+		gsize literal_len = literal ? strlen(literal) : 0;
+		gboolean caseless = g_regex_get_compile_flags(regex) & G_REGEX_CASELESS;
 
 		for (;;)
 		{
-			gint start = sci_get_position_from_line(sci, line);
-			gint end = sci_get_line_end_position(sci, line);
+			gint start, end;
 
-			text = (void*)SSM(sci, SCI_GETRANGEPOINTER, start, end - start);
-			if (g_regex_match_full(regex, text, end - start, pos - start, 0, &minfo, NULL))
+			if (literal)
+			{
+				/* skip the lines not containing the literal */
+				const gchar *found = find_literal(text + pos, document_length - pos,
+					literal, literal_len, caseless);
+
+				if (! found)
+					break;
+				line = sci_get_line_from_position(sci, found - text);
+				pos = MAX(pos, (guint) sci_get_position_from_line(sci, line));
+			}
+			start = sci_get_position_from_line(sci, line);
+			end = sci_get_line_end_position(sci, line);
+
+			if (g_regex_match_full(regex, text + start, end - start, pos - start, 0, &minfo, NULL))
 			{
 				offset = start;
 				break;
 			}
 			else /* not found, try next line */
 			{
+				g_match_info_free(minfo);
+				minfo = NULL;
 				line ++;
-				if (line >= sci_get_line_count(sci))
+				if (line >= line_count)
 					break;
 				pos = sci_get_position_from_line(sci, line);
-				/* don't free last info, it's freed below */
-				g_match_info_free(minfo);
 			}
 		}
+		g_free(literal);
 	}
 
 	/* Warning: minfo will become invalid when 'text' does! */
-	if (g_match_info_matches(minfo))
+	if (minfo && g_match_info_matches(minfo))
 	{
 		guint i;
 
@@ -2102,7 +2333,8 @@ static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean
 		match->end = match->matches[0].end;
 		ret = match->start;
 	}
-	g_match_info_free(minfo);
+	if (minfo)
+		g_match_info_free(minfo);
 	return ret;
 }
 
@@ -2131,6 +2363,7 @@ gint search_find_prev(ScintillaObject *sci, const gchar *str, GeanyFindFlags fla
 }
 
 
+GEANY_EXPORT_SYMBOL
 gint search_find_next(ScintillaObject *sci, const gchar *str, GeanyFindFlags flags, GeanyMatchInfo **match_)
 {
 	GeanyMatchInfo *match;
@@ -2216,26 +2449,13 @@ gint search_replace_match(ScintillaObject *sci, const GeanyMatchInfo *match, con
 }
 
 
-gint search_find_text(ScintillaObject *sci, GeanyFindFlags flags, struct Sci_TextToFind *ttf, GeanyMatchInfo **match_)
+/* Like search_find_text() with an already compiled regex */
+static gint find_text_regex(ScintillaObject *sci, GRegex *regex, GeanyFindFlags flags,
+		struct Sci_TextToFind *ttf, GeanyMatchInfo **match_)
 {
-	GeanyMatchInfo *match = NULL;
-	GRegex *regex;
+	GeanyMatchInfo *match = match_info_new(flags, 0, 0);
 	gint ret;
 
-	if (~flags & GEANY_FIND_REGEXP)
-	{
-		ret = sci_find_text(sci, geany_find_flags_to_sci_flags(flags), ttf);
-		if (ret != -1 && match_)
-			*match_ = match_info_new(flags, ttf->chrgText.cpMin, ttf->chrgText.cpMax);
-		return ret;
-	}
-
-	regex = compile_regex(ttf->lpstrText, flags);
-	if (!regex)
-		return -1;
-
-	match = match_info_new(flags, 0, 0);
-
 	ret = find_regex(sci, ttf->chrg.cpMin, regex, flags & GEANY_FIND_MULTILINE, match);
 	if (ret >= ttf->chrg.cpMax)
 		ret = -1;
@@ -2250,6 +2470,28 @@ gint search_find_text(ScintillaObject *sci, GeanyFindFlags flags, struct Sci_Tex
 	else
 		geany_match_info_free(match);
 
+	return ret;
+}
+
+
+gint search_find_text(ScintillaObject *sci, GeanyFindFlags flags, struct Sci_TextToFind *ttf, GeanyMatchInfo **match_)
+{
+	GRegex *regex;
+	gint ret;
+
+	if (~flags & GEANY_FIND_REGEXP)
+	{
+		ret = sci_find_text(sci, geany_find_flags_to_sci_flags(flags), ttf);
+		if (ret != -1 && match_)
+			*match_ = match_info_new(flags, ttf->chrgText.cpMin, ttf->chrgText.cpMax);
+		return ret;
+	}
+
+	regex = compile_regex(ttf->lpstrText, flags);
+	if (!regex)
+		return -1;
+
+	ret = find_text_regex(sci, regex, flags, ttf, match_);
 	g_regex_unref(regex);
 	return ret;
 }
@@ -143,6 +143,8 @@ gint search_replace_match(struct _ScintillaObject *sci, const GeanyMatchInfo *ma
 guint search_replace_range(struct _ScintillaObject *sci, struct Sci_TextToFind *ttf,
 		GeanyFindFlags flags, const gchar *replace_text);
 
+gchar *search_get_regex_required_literal(GRegex *regex);
+
 #endif /* GEANY_PRIVATE */
 
 G_END_DECLS
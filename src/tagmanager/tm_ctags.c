@@ -20,6 +20,7 @@
 #include "writer_p.h"
 #include "xtag_p.h"
 #include "param_p.h"
+#include "read_p.h"
 
 #include <string.h>
 #include <errno.h>
@@ -28,6 +29,10 @@
 static gint write_entry(tagWriter *writer, MIO * mio, const tagEntryInfo *const tag, void *user_data);
 static void rescan_failed(tagWriter *writer, gulong valid_tag_num, void *user_data);
 
+/* per-parse limits, 0 means unlimited */
+static gsize parse_max_bytes = 0;
+static guint parse_max_msec = 0;
+
 tagWriter geanyWriter = {
 	.writeEntry = write_entry,
 	.writePtagEntry = NULL, /* no pseudo-tags */
@@ -118,7 +123,7 @@ static void enable_kinds_and_roles(void)
  @param tag_entry Tag information gathered by the ctags parser
  @return TRUE on success, FALSE on failure
 */
-static gboolean init_tag(TMTag *tag, TMSourceFile *file, const tagEntryInfo *tag_entry)
+static gboolean init_tag(TMTag *tag, TMSourceFile *file, tagEntryInfo *tag_entry)
 {
 	TMTagType type;
 	guchar kind_letter;
@@ -147,15 +152,14 @@ static gboolean init_tag(TMTag *tag, TMSourceFile *file, const tagEntryInfo *tag
 		tag->flags |= tm_tag_flag_anon_t;
 	tag->kind_letter = kind_letter;
 	tag->line = tag_entry->lineNumber;
-	if (NULL != tag_entry->extensionFields.signature)
-		tag->arglist = g_strdup(tag_entry->extensionFields.signature);
+	/* take over the strings of corked entries instead of copying them - ctags
+	 * allocates with malloc() which GLib >= 2.46 guarantees g_free() can free */
+	tag->arglist = takeTagEntryString(tag_entry, &tag_entry->extensionFields.signature);
 	if ((NULL != tag_entry->extensionFields.scopeName) &&
 		(0 != tag_entry->extensionFields.scopeName[0]))
-		tag->scope = g_strdup(tag_entry->extensionFields.scopeName);
-	if (tag_entry->extensionFields.inheritance != NULL)
-		tag->inheritance = g_strdup(tag_entry->extensionFields.inheritance);
-	if (tag_entry->extensionFields.typeRef[1] != NULL)
-		tag->var_type = g_strdup(tag_entry->extensionFields.typeRef[1]);
+		tag->scope = takeTagEntryString(tag_entry, &tag_entry->extensionFields.scopeName);
+	tag->inheritance = takeTagEntryString(tag_entry, &tag_entry->extensionFields.inheritance);
+	tag->var_type = takeTagEntryString(tag_entry, &tag_entry->extensionFields.typeRef[1]);
 	if (tag_entry->extensionFields.access != NULL)
 		tag->access = tm_source_file_get_tag_access(tag_entry->extensionFields.access);
 	if (tag_entry->extensionFields.implementation != NULL)
@@ -186,7 +190,7 @@ static gint write_entry(tagWriter *writer, MIO * mio, const tagEntryInfo *const
 
 	getTagScopeInformation((tagEntryInfo *)tag, NULL, NULL);
 
-	if (!init_tag(tm_tag, source_file, tag))
+	if (!init_tag(tm_tag, source_file, (tagEntryInfo *)tag))
 	{
 		tm_tag_unref(tm_tag);
 		return 0;
@@ -256,6 +260,17 @@ void tm_ctags_add_ignore_symbol(const char *value)
 }
 
 
+/* Limits how much input and time a single tm_ctags_parse() may consume. When
+ * either runs out, parsing stops early, the tags found so far are kept and
+ * the source file is flagged as partial. Pass 0 to remove a limit. */
+GEANY_EXPORT_SYMBOL
+void tm_ctags_set_parse_budget(gsize max_bytes, guint max_msec)
+{
+	parse_max_bytes = max_bytes;
+	parse_max_msec = max_msec;
+}
+
+
 void tm_ctags_clear_ignore_symbols(void)
 {
 	langType lang = getNamedLanguage ("CPreProcessor", 0);
@@ -461,16 +476,32 @@ static void rename_anon_tags(TMSourceFile *source_file)
 }
 
 
+static bool parse_deadline_reached(void *data)
+{
+	gint64 *deadline = data;
+
+	return g_get_monotonic_time() >= *deadline;
+}
+
+
 void tm_ctags_parse(guchar *buffer, gsize buffer_size,
 	const gchar *file_name, TMParserType language, TMSourceFile *source_file)
 {
+	gint64 deadline;
+
 	g_return_if_fail(buffer != NULL || file_name != NULL);
 
 	if (language == TM_PARSER_NONE)
 		return;
 
+	deadline = g_get_monotonic_time() + (gint64) parse_max_msec * 1000;
+	setInputBudget(parse_max_bytes, parse_max_msec > 0 ? parse_deadline_reached : NULL, &deadline);
+
 	parseRawBuffer(file_name, buffer, buffer_size, language, source_file);
 
+	source_file->partial = isInputBudgetExhausted();
+	setInputBudget(0, NULL, NULL);
+
 	rename_anon_tags(source_file);
 }
 
@@ -20,6 +20,7 @@ G_BEGIN_DECLS
 void tm_ctags_init(void);
 void tm_ctags_add_ignore_symbol(const char *value);
 void tm_ctags_clear_ignore_symbols(void);
+void tm_ctags_set_parse_budget(gsize max_bytes, guint max_msec);
 void tm_ctags_parse(guchar *buffer, gsize buffer_size,
 	const gchar *file_name, TMParserType language, TMSourceFile *source_file);
 const gchar *tm_ctags_get_lang_name(TMParserType lang);
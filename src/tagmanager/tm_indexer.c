@@ -0,0 +1,477 @@
+/*
+*   Copyright 2026 The Geany contributors
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Standalone batch indexer. Parses a list of files with the tag manager and
+*   writes a single global tags file, like "geany -g -P" but without Geany.
+*   The ctags parsers keep global state, so the files are split across worker
+*   processes (this same program run with --worker) instead of threads, and
+*   their tags files are merged at the end.
+*/
+
+#include "tm_source_file.h"
+#include "tm_workspace.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* exit status of a worker whose files have no symbols, so it didn't write a tags file */
+#define WORKER_EXIT_NO_SYMBOLS 2
+
+
+typedef struct
+{
+	gchar *name;
+	goffset size;
+} IndexerFile;
+
+typedef struct
+{
+	GPtrArray *files;	/* borrowed file names */
+	goffset size;
+	gchar *list_file;
+	gchar *tags_file;
+	gboolean failed;
+	gboolean no_symbols;
+} IndexerShard;
+
+
+static gchar *language = NULL;
+static gchar *output_file = NULL;
+static gchar *list_file = NULL;
+static gint num_jobs = 0;
+static gboolean worker_mode = FALSE;
+static gboolean quiet = FALSE;
+
+static GOptionEntry entries[] =
+{
+	{ "language", 'l', 0, G_OPTION_ARG_STRING, &language, "Parse all files as LANG (a ctags parser name such as C or Python)", "LANG" },
+	{ "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file, "Write the tags to FILE", "FILE" },
+	{ "file-list", 'L', 0, G_OPTION_ARG_FILENAME, &list_file, "Read the files to parse from FILE, one per line (- for stdin)", "FILE" },
+	{ "jobs", 'j', 0, G_OPTION_ARG_INT, &num_jobs, "Use N worker processes (default: number of CPUs)", "N" },
+	{ "quiet", 'q', 0, G_OPTION_ARG_NONE, &quiet, "Don't print throughput statistics", NULL },
+	{ "worker", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &worker_mode, NULL, NULL },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
+
+static gboolean read_file_list(const gchar *path, GPtrArray *names)
+{
+	gchar *contents = NULL;
+	gchar **lines, **line;
+	GError *error = NULL;
+
+	if (strcmp(path, "-") == 0)
+	{
+		GString *str = g_string_new(NULL);
+		gchar buf[4096];
+		gsize len;
+
+		while ((len = fread(buf, 1, sizeof(buf), stdin)) > 0)
+			g_string_append_len(str, buf, len);
+		contents = g_string_free(str, FALSE);
+	}
+	else if (!g_file_get_contents(path, &contents, NULL, &error))
+	{
+		g_printerr("Failed to read file list: %s\n", error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	lines = g_strsplit_set(contents, "\r\n", -1);
+	for (line = lines; *line; line++)
+	{
+		if (**line)
+			g_ptr_array_add(names, g_strdup(*line));
+	}
+	g_strfreev(lines);
+	g_free(contents);
+	return TRUE;
+}
+
+
+static gint compare_file_size(gconstpointer a, gconstpointer b)
+{
+	const IndexerFile *fa = *(const IndexerFile **) a;
+	const IndexerFile *fb = *(const IndexerFile **) b;
+
+	/* biggest first */
+	if (fa->size != fb->size)
+		return fa->size < fb->size ? 1 : -1;
+	return strcmp(fa->name, fb->name);
+}
+
+
+/* Drops duplicates and non-regular files and sorts the rest by decreasing
+ * size. The returned entries borrow their names from the names array. */
+static GPtrArray *collect_files(GPtrArray *names, goffset *total_size)
+{
+	GPtrArray *files = g_ptr_array_new_with_free_func(g_free);
+	GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+	guint i;
+
+	*total_size = 0;
+	for (i = 0; i < names->len; i++)
+	{
+		const gchar *name = names->pdata[i];
+		GStatBuf st;
+		IndexerFile *file;
+
+		if (g_hash_table_contains(seen, name))
+			continue;
+		g_hash_table_add(seen, (gpointer) name);
+
+		if (!g_file_test(name, G_FILE_TEST_IS_REGULAR) || g_stat(name, &st) != 0)
+		{
+			g_printerr("Skipping \"%s\": not a regular file\n", name);
+			continue;
+		}
+
+		file = g_new(IndexerFile, 1);
+		file->name = (gchar *) name;
+		file->size = st.st_size;
+		g_ptr_array_add(files, file);
+		*total_size += st.st_size;
+	}
+	g_hash_table_destroy(seen);
+
+	g_ptr_array_sort(files, compare_file_size);
+	return files;
+}
+
+
+/* Hands out the files biggest first, each to the currently lightest shard,
+ * so that a few huge files don't end up on the same worker. */
+static IndexerShard *make_shards(GPtrArray *files, guint shard_count)
+{
+	IndexerShard *shards = g_new0(IndexerShard, shard_count);
+	guint i, j;
+
+	for (i = 0; i < shard_count; i++)
+		shards[i].files = g_ptr_array_new();
+
+	for (i = 0; i < files->len; i++)
+	{
+		IndexerFile *file = files->pdata[i];
+		IndexerShard *lightest = &shards[0];
+
+		for (j = 1; j < shard_count; j++)
+		{
+			if (shards[j].size < lightest->size)
+				lightest = &shards[j];
+		}
+		g_ptr_array_add(lightest->files, file->name);
+		lightest->size += file->size;
+	}
+	return shards;
+}
+
+
+static gboolean write_shard_list(IndexerShard *shard)
+{
+	GString *str = g_string_new(NULL);
+	GError *error = NULL;
+	gboolean ret;
+	guint i;
+
+	for (i = 0; i < shard->files->len; i++)
+	{
+		g_string_append(str, shard->files->pdata[i]);
+		g_string_append_c(str, '\n');
+	}
+
+	ret = g_file_set_contents(shard->list_file, str->str, str->len, &error);
+	if (!ret)
+	{
+		g_printerr("Failed to write file list: %s\n", error->message);
+		g_error_free(error);
+	}
+	g_string_free(str, TRUE);
+	return ret;
+}
+
+
+typedef struct
+{
+	GMainLoop *loop;
+	IndexerShard *shard;
+	guint *pending;
+} WorkerData;
+
+
+static void on_worker_exit(GPid pid, gint status, gpointer user_data)
+{
+	WorkerData *data = user_data;
+	GError *error = NULL;
+
+#if GLIB_CHECK_VERSION(2, 70, 0)
+	if (!g_spawn_check_wait_status(status, &error))
+#else
+	if (!g_spawn_check_exit_status(status, &error))
+#endif
+	{
+		if (error->domain == G_SPAWN_EXIT_ERROR && error->code == WORKER_EXIT_NO_SYMBOLS)
+			data->shard->no_symbols = TRUE;
+		else
+		{
+			g_printerr("Worker for %u files failed: %s\n", data->shard->files->len, error->message);
+			data->shard->failed = TRUE;
+		}
+		g_error_free(error);
+	}
+	g_spawn_close_pid(pid);
+
+	if (--(*data->pending) == 0)
+		g_main_loop_quit(data->loop);
+	g_free(data);
+}
+
+
+static gboolean run_workers(const gchar *self, IndexerShard *shards, guint shard_count)
+{
+	GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+	guint pending = 0;
+	gboolean ret = TRUE;
+	guint i;
+
+	for (i = 0; i < shard_count; i++)
+	{
+		IndexerShard *shard = &shards[i];
+		const gchar *argv[] = {
+			self, "--worker", "--quiet",
+			"--language", language,
+			"--file-list", shard->list_file,
+			"--output", shard->tags_file,
+			NULL
+		};
+		GError *error = NULL;
+		WorkerData *data;
+		GPid pid;
+
+		if (!g_spawn_async(NULL, (gchar **) argv, NULL,
+				G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &pid, &error))
+		{
+			g_printerr("Failed to start worker: %s\n", error->message);
+			g_error_free(error);
+			shard->failed = TRUE;
+			ret = FALSE;
+			continue;
+		}
+
+		data = g_new(WorkerData, 1);
+		data->loop = loop;
+		data->shard = shard;
+		data->pending = &pending;
+		pending++;
+		g_child_watch_add(pid, on_worker_exit, data);
+	}
+
+	if (pending > 0)
+		g_main_loop_run(loop);
+	g_main_loop_unref(loop);
+
+	for (i = 0; i < shard_count; i++)
+	{
+		if (shards[i].failed)
+			ret = FALSE;
+	}
+	return ret;
+}
+
+
+static gboolean index_in_workers(const gchar *self, GPtrArray *files, guint jobs,
+	TMParserType lang)
+{
+	IndexerShard *shards = make_shards(files, jobs);
+	GPtrArray *tags_files = g_ptr_array_new();
+	GError *error = NULL;
+	gboolean ret = FALSE;
+	gchar *tmp_dir;
+	guint i;
+
+	tmp_dir = g_dir_make_tmp("tm-indexer-XXXXXX", &error);
+	if (!tmp_dir)
+	{
+		g_printerr("Failed to create temporary directory: %s\n", error->message);
+		g_error_free(error);
+		goto cleanup;
+	}
+
+	for (i = 0; i < jobs; i++)
+	{
+		gchar *name = g_strdup_printf("shard%u.list", i);
+
+		shards[i].list_file = g_build_filename(tmp_dir, name, NULL);
+		g_free(name);
+		name = g_strdup_printf("shard%u.tags", i);
+		shards[i].tags_file = g_build_filename(tmp_dir, name, NULL);
+		g_free(name);
+
+		if (!write_shard_list(&shards[i]))
+			goto cleanup;
+	}
+
+	if (!run_workers(self, shards, jobs))
+		goto cleanup;
+
+	for (i = 0; i < jobs; i++)
+	{
+		if (!shards[i].no_symbols)
+			g_ptr_array_add(tags_files, shards[i].tags_file);
+	}
+	ret = tm_workspace_merge_global_tags((const gchar **) tags_files->pdata,
+		tags_files->len, output_file, lang);
+
+cleanup:
+	for (i = 0; i < jobs; i++)
+	{
+		if (shards[i].list_file)
+			g_unlink(shards[i].list_file);
+		if (shards[i].tags_file)
+			g_unlink(shards[i].tags_file);
+		g_free(shards[i].list_file);
+		g_free(shards[i].tags_file);
+		g_ptr_array_free(shards[i].files, TRUE);
+	}
+	g_free(shards);
+	g_ptr_array_free(tags_files, TRUE);
+	if (tmp_dir)
+		g_rmdir(tmp_dir);
+	g_free(tmp_dir);
+	return ret;
+}
+
+
+static gboolean index_in_process(GPtrArray *files, TMParserType lang)
+{
+	GPtrArray *names = g_ptr_array_sized_new(files->len);
+	gboolean ret;
+	guint i;
+
+	for (i = 0; i < files->len; i++)
+		g_ptr_array_add(names, ((IndexerFile *) files->pdata[i])->name);
+
+	ret = tm_workspace_create_global_tags(NULL, (const gchar **) names->pdata,
+		names->len, output_file, lang);
+
+	g_ptr_array_free(names, TRUE);
+	return ret;
+}
+
+
+/* Returns the exit status of a worker. tm_workspace_create_global_tags() fails the same way
+ * when there are no symbols and when the tags file can't be written, so the file is created
+ * first and an empty one afterwards means there were no symbols. */
+static gint index_in_worker(GPtrArray *files, TMParserType lang)
+{
+	GError *error = NULL;
+	GStatBuf st;
+
+	/* the parent never makes empty shards, but a file list can still be empty */
+	if (files->len == 0)
+		return WORKER_EXIT_NO_SYMBOLS;
+
+	if (!g_file_set_contents(output_file, "", 0, &error))
+	{
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		return 1;
+	}
+
+	if (index_in_process(files, lang))
+		return 0;
+	if (g_stat(output_file, &st) == 0 && st.st_size == 0)
+		return WORKER_EXIT_NO_SYMBOLS;
+	return 1;
+}
+
+
+int main(int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	GPtrArray *names, *files;
+	TMParserType lang;
+	goffset total_size;
+	gboolean ret;
+	GTimer *timer;
+	guint jobs;
+	gint i;
+
+	context = g_option_context_new("[FILE...] - create a global tags file");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &error))
+	{
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		g_option_context_free(context);
+		return 1;
+	}
+	g_option_context_free(context);
+
+	if (!language || !output_file)
+	{
+		g_printerr("Usage: %s -l LANG -o TAGS_FILE [-j N] [-L FILE_LIST] [FILE...]\n", argv[0]);
+		return 1;
+	}
+
+	/* initializes ctags */
+	tm_get_workspace();
+
+	lang = tm_source_file_get_named_lang(language);
+	if (lang == TM_PARSER_NONE)
+	{
+		g_printerr("Unknown language \"%s\"\n", language);
+		return 1;
+	}
+
+	names = g_ptr_array_new_with_free_func(g_free);
+	for (i = 1; i < argc; i++)
+		g_ptr_array_add(names, g_strdup(argv[i]));
+	if (list_file && !read_file_list(list_file, names))
+		return 1;
+
+	files = collect_files(names, &total_size);
+
+	if (worker_mode)
+		return index_in_worker(files, lang);
+
+	if (files->len == 0)
+	{
+		g_printerr("No files to parse\n");
+		return 1;
+	}
+
+	jobs = num_jobs > 0 ? (guint) num_jobs : g_get_num_processors();
+	jobs = MIN(jobs, files->len);
+
+	timer = g_timer_new();
+	if (jobs > 1)
+		ret = index_in_workers(argv[0], files, jobs, lang);
+	else
+		ret = index_in_process(files, lang);
+	g_timer_stop(timer);
+
+	if (!ret)
+		g_printerr("Failed to create tags file, perhaps because no symbols were found.\n");
+	else if (!quiet)
+	{
+		gdouble elapsed = MAX(g_timer_elapsed(timer, NULL), 1e-6);
+
+		g_printerr("Indexed %u files (%.1f MiB) in %.2f s using %u process(es): "
+			"%.1f files/s, %.1f MiB/s\n",
+			files->len, total_size / (1024.0 * 1024.0), elapsed, jobs,
+			files->len / elapsed, total_size / (1024.0 * 1024.0) / elapsed);
+	}
+
+	g_timer_destroy(timer);
+	g_ptr_array_free(files, TRUE);
+	g_ptr_array_free(names, TRUE);
+	g_free(language);
+	g_free(output_file);
+	g_free(list_file);
+	return ret ? 0 : 1;
+}
@@ -631,6 +631,7 @@ static gboolean tm_source_file_init(TMSourceFile *source_file, const char *file_
 		source_file->lang = tm_ctags_get_named_lang(name);
 
 	source_file->trust_file_scope = TRUE;
+	source_file->partial = FALSE;
 
 	if (source_file->lang == TM_PARSER_C || source_file->lang == TM_PARSER_CPP)
 	{
@@ -735,6 +736,7 @@ G_DEFINE_BOXED_TYPE(TMSourceFile, tm_source_file, tm_source_file_dup, tm_source_
  TRUE to parse the buffer and ignore the file content.
  @return TRUE on success, FALSE on failure
 */
+GEANY_EXPORT_SYMBOL
 gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize buf_size,
 	gboolean use_buffer)
 {
@@ -747,6 +749,8 @@ gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize
 		return FALSE;
 	}
 
+	source_file->partial = FALSE;
+
 	if (source_file->lang == TM_PARSER_NONE)
 	{
 		tm_tags_array_free(source_file->tags_array, FALSE);
@@ -36,6 +36,10 @@ typedef struct TMSourceFile
 	char *short_name; /**< Just the name of the file (without the path) */
 	GPtrArray *tags_array; /**< Sorted tag array obtained by parsing the object. @elementtype{TMTag} */
 	gboolean trust_file_scope;
+	/** Whether the last parse ran out of its size or time budget, so that @a tags_array
+	 * is incomplete.
+	 * @since 2.2 (API 252) */
+	gboolean partial;
 } TMSourceFile;
 
 GType tm_source_file_get_type(void);
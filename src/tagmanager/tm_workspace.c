@@ -119,6 +119,7 @@ void tm_workspace_free(void)
  a workspace is created. Subsequent calls to the function will return the
  created workspace.
 */
+GEANY_EXPORT_SYMBOL
 const TMWorkspace *tm_get_workspace(void)
 {
 	if (NULL == theWorkspace)
@@ -612,6 +613,43 @@ gboolean tm_workspace_create_global_tags(const char *pre_process_cmd, const char
 	return ret;
 }
 
+/* Merges tags files created by tm_workspace_create_global_tags() for the same
+ language into a single one, e.g. to combine the results of parallel runs.
+ @param sources Tags files to merge.
+ @param sources_count Number of tags files.
+ @param tags_file The file where the merged tags will be stored.
+ @param lang The language of the tags files.
+ @return TRUE on success, FALSE on failure or if there were no tags to write.
+*/
+gboolean tm_workspace_merge_global_tags(const char **sources, int sources_count,
+	const char *tags_file, TMParserType lang)
+{
+	GPtrArray *tags = g_ptr_array_new();
+	gboolean ret = FALSE;
+	gint i;
+
+	for (i = 0; i < sources_count; i++)
+	{
+		GPtrArray *file_tags = tm_source_file_read_tags_file(sources[i], lang);
+		guint j;
+
+		if (!file_tags)
+			continue;
+		for (j = 0; j < file_tags->len; j++)
+			g_ptr_array_add(tags, file_tags->pdata[j]);
+		g_ptr_array_free(file_tags, TRUE);
+	}
+
+	/* the same header can be parsed by several runs, drop the duplicates */
+	tm_tags_sort(tags, global_tags_sort_attrs, TRUE, TRUE);
+
+	if (tags->len > 0)
+		ret = tm_source_file_write_tags_file(tags_file, tags);
+
+	tm_tags_array_free(tags, TRUE);
+	return ret;
+}
+
 static void fill_find_tags_array(GPtrArray *dst, const GPtrArray *src,
 	const char *name, const char *scope, TMTagType type, TMParserType lang)
 {
@@ -54,6 +54,9 @@ gboolean tm_workspace_load_global_tags(const char *tags_file, TMParserType mode)
 gboolean tm_workspace_create_global_tags(const char *pre_process, const char **includes,
 	int includes_count, const char *tags_file, TMParserType lang);
 
+gboolean tm_workspace_merge_global_tags(const char **sources, int sources_count,
+	const char *tags_file, TMParserType lang);
+
 GPtrArray *tm_workspace_find(const char *name, const char *scope, TMTagType type,
 	TMTagAttrType *attrs, TMParserType lang);
 
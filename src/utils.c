@@ -111,61 +111,149 @@ void utils_open_browser(const gchar *uri)
 }
 
 
-/* taken from anjuta, to determine the EOL mode of the file */
-gint utils_get_line_endings(const gchar* buffer, gsize size)
+#define ONES_64 G_GUINT64_CONSTANT(0x0101010101010101)
+#define HIGH_BITS_64 G_GUINT64_CONSTANT(0x8080808080808080)
+/* whether any byte of word is 0 */
+#define HAS_ZERO_BYTE_64(word) ((((word) - ONES_64) & ~(word) & HIGH_BITS_64) != 0)
+
+/* Counts the 0 bytes of a word whose bytes are all < 0x80. */
+static guint count_zero_bytes_ascii(guint64 word)
 {
-	gsize i;
-	guint cr, lf, crlf, max_mode;
-	gint mode;
+	guint64 zeros = ~(word + (HIGH_BITS_64 - ONES_64)) & HIGH_BITS_64;
 
-	cr = lf = crlf = 0;
+	return (guint) (((zeros >> 7) * ONES_64) >> 56);
+}
+
+
+/* Returns the length of the well-formed UTF-8 multibyte sequence at p, or 0. This
+ * accepts the same as g_utf8_validate(): no overlongs, surrogates or code points
+ * above U+10FFFF. */
+static gsize utf8_sequence_length(const guchar *p, gsize avail)
+{
+	guchar lo = 0x80, hi = 0xbf;
+	gsize len, i;
 
-	for (i = 0; i < size ; i++)
+	if (p[0] >= 0xc2 && p[0] <= 0xdf)
+		len = 2;
+	else if (p[0] >= 0xe0 && p[0] <= 0xef)
 	{
-		if (buffer[i] == 0x0a)
+		len = 3;
+		if (p[0] == 0xe0)
+			lo = 0xa0;
+		else if (p[0] == 0xed)
+			hi = 0x9f;
+	}
+	else if (p[0] >= 0xf0 && p[0] <= 0xf4)
+	{
+		len = 4;
+		if (p[0] == 0xf0)
+			lo = 0x90;
+		else if (p[0] == 0xf4)
+			hi = 0x8f;
+	}
+	else
+		return 0;
+
+	if (avail < len || p[1] < lo || p[1] > hi)
+		return 0;
+	for (i = 2; i < len; i++)
+	{
+		if ((p[i] & 0xc0) != 0x80)
+			return 0;
+	}
+	return len;
+}
+
+
+/* Validates UTF-8, finds NULs and counts line endings in a single pass over buffer.
+ * Runs of 8 ASCII bytes without NUL or CR are handled a word at a time, so that
+ * plain text costs little more than a memchr(). */
+GEANY_EXPORT_SYMBOL
+void utils_scan_text(const gchar *buffer, gsize size, GeanyTextScan *scan)
+{
+	const guchar *p = (const guchar *) buffer;
+	gsize i = 0;
+	gsize cr = 0, lf = 0, crlf = 0, max_count;
+	gboolean valid = TRUE;
+
+	scan->valid_len = size;
+	scan->nul_pos = size;
+
+	while (i < size)
+	{
+		guchar c;
+
+		if (i + 8 <= size)
 		{
-			/* LF */
-			lf++;
+			guint64 word;
+
+			memcpy(&word, p + i, 8);
+			if ((word & HIGH_BITS_64) == 0 && ! HAS_ZERO_BYTE_64(word) &&
+				! HAS_ZERO_BYTE_64(word ^ ('\r' * ONES_64)))
+			{
+				lf += count_zero_bytes_ascii(word ^ ('\n' * ONES_64));
+				i += 8;
+				continue;
+			}
 		}
-		else if (buffer[i] == 0x0d)
+
+		c = p[i];
+		if (c == '\n')
+			lf++;
+		else if (c == '\r')
 		{
-			if (i >= (size - 1))
+			if (i + 1 < size && p[i + 1] == '\n')
 			{
-				/* Last char, CR */
-				cr++;
+				crlf++;
+				i++;
 			}
 			else
+				cr++;
+		}
+		else if (c == '\0')
+		{
+			if (scan->nul_pos == size)
+				scan->nul_pos = i;
+		}
+		else if (c >= 0x80 && valid)
+		{
+			/* multibyte sequences never contain NUL, CR or LF bytes */
+			gsize len = utf8_sequence_length(p + i, size - i);
+
+			if (len > 0)
 			{
-				if (buffer[i + 1] != 0x0a)
-				{
-					/* CR */
-					cr++;
-				}
-				else
-				{
-					/* CRLF */
-					crlf++;
-				}
-				i++;
+				i += len;
+				continue;
 			}
+			valid = FALSE;
+			scan->valid_len = i;
 		}
+		i++;
 	}
 
+	scan->lines = cr + lf + crlf + 1;
+
 	/* Vote for the maximum */
-	mode = SC_EOL_LF;
-	max_mode = lf;
-	if (crlf > max_mode)
-	{
-		mode = SC_EOL_CRLF;
-		max_mode = crlf;
-	}
-	if (cr > max_mode)
+	scan->eol_mode = SC_EOL_LF;
+	max_count = lf;
+	if (crlf > max_count)
 	{
-		mode = SC_EOL_CR;
-		max_mode = cr;
+		scan->eol_mode = SC_EOL_CRLF;
+		max_count = crlf;
 	}
+	if (cr > max_count)
+		scan->eol_mode = SC_EOL_CR;
+}
+
+
+/* taken from anjuta, to determine the EOL mode of the file */
+GEANY_EXPORT_SYMBOL
+gint utils_get_line_endings(const gchar* buffer, gsize size)
+{
+	GeanyTextScan scan;
 
-	return mode;
+	utils_scan_text(buffer, size, &scan);
+	return scan.eol_mode;
 }
 
 
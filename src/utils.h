@@ -235,9 +235,20 @@ typedef enum
 	RESOURCE_DIR_COUNT
 } GeanyResourceDirType;
 
+/* Result of utils_scan_text() */
+typedef struct GeanyTextScan
+{
+	gsize	valid_len;	/* length of the valid UTF-8 start of the text, which may contain NULs */
+	gsize	nul_pos;	/* offset of the first NUL, or the text size */
+	gsize	lines;		/* number of lines */
+	gint	eol_mode;	/* most used line ending, see utils_get_line_endings() */
+} GeanyTextScan;
+
 
 gint utils_get_line_endings(const gchar* buffer, gsize size);
 
+void utils_scan_text(const gchar *buffer, gsize size, GeanyTextScan *scan);
+
 gboolean utils_isbrace(gchar c, gboolean include_angles);
 
 gboolean utils_is_opening_brace(gchar c, gboolean include_angles);
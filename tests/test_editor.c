@@ -0,0 +1,1154 @@
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "geanyminimap.h"
+#include "main.h"
+#include "sciwrappers.h"
+#include "SciLexer.h"
+
+#define EDITOR_TEST_ADD(path, func) g_test_add_func("/editor/" path, func);
+
+#define REWRAP_LINES 20000
+#define REWRAP_LINE_LENGTH 600
+
+#define BACKGROUND_WRAP_LINES 5000
+#define BACKGROUND_WRAP_TIMEOUT 30	/* seconds */
+
+#define FIND_TEXT_SIZE (100 * 1024 * 1024)
+
+#define HIGHLIGHT_TYPENAMES 50000
+#define HIGHLIGHT_TEXT_SIZE (20 * 1024 * 1024)
+
+#define HTML_TEXT_SIZE (5 * 1024 * 1024)
+#define HTML_HEREDOC_LINES 3000
+#define HTML_EDITS 100
+#define HTML_PAGE_LINES 60
+
+#define MARK_ALL_MATCHES 1000000
+
+#define COLUMN_LINES 4
+#define COLUMN_LINE_LENGTH 20000
+#define COLUMN_EDITS 3000
+
+#define UNDO_MEMORY_LIMIT 256	/* bytes */
+#define UNDO_EDITS 2000
+
+#define FOLD_BLOCKS 200000
+
+#define ACCESSIBLE_TEXT_SIZE (20 * 1024 * 1024)
+#define ACCESSIBLE_QUERIES 1000
+
+#define MINIMAP_LINES 1000000
+#define MINIMAP_EDITS 200
+
+
+static void fill_long_lines(ScintillaObject *sci)
+{
+	GString *text = g_string_sized_new(REWRAP_LINES * (REWRAP_LINE_LENGTH + 1));
+	gint i;
+
+	for (i = 0; i < REWRAP_LINES; i++)
+	{
+		gsize line_start = text->len;
+
+		while (text->len - line_start < REWRAP_LINE_LENGTH)
+			g_string_append_printf(text, "word%d ", g_test_rand_int_range(0, 100000));
+		g_string_append_c(text, '\n');
+	}
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+}
+
+
+/* Resizes the view and waits until the whole document has been rewrapped.
+ * Returns the elapsed time in seconds. */
+static gdouble resize_and_rewrap(GtkWidget *window, ScintillaObject *sci, gint width)
+{
+	g_test_timer_start();
+
+	gtk_window_resize(GTK_WINDOW(window), width, 400);
+	while (gtk_widget_get_allocated_width(GTK_WIDGET(sci)) != width)
+		gtk_main_iteration_do(FALSE);
+	/* needs the whole document to be wrapped to find out the display line */
+	SSM(sci, SCI_ENSUREVISIBLE, sci_get_line_count(sci) - 1, 0);
+
+	return g_test_timer_elapsed();
+}
+
+
+static void test_editor_rewrap_perf(void)
+{
+	static const gint widths[] = { 900, 500, 1200, 700 };
+	guint threads[] = { 1, g_get_num_processors() };
+	GtkWidget *window;
+	ScintillaObject *sci;
+	guint t, w;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	window = gtk_offscreen_window_new();
+	sci = SCINTILLA(scintilla_new());
+	gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(sci));
+	gtk_window_set_default_size(GTK_WINDOW(window), 800, 400);
+	gtk_widget_show_all(window);
+
+	sci_set_codepage(sci, SC_CP_UTF8);
+	sci_set_lines_wrapped(sci, TRUE);
+	fill_long_lines(sci);
+
+	for (t = 0; t < G_N_ELEMENTS(threads); t++)
+	{
+		gdouble total = 0;
+
+		SSM(sci, SCI_SETLAYOUTTHREADS, threads[t], 0);
+		for (w = 0; w < G_N_ELEMENTS(widths); w++)
+			total += resize_and_rewrap(window, sci, widths[w]);
+
+		g_test_message("%u layout thread(s): %.3f s per rewrap of %d lines",
+			(guint) SSM(sci, SCI_GETLAYOUTTHREADS, 0, 0), total / G_N_ELEMENTS(widths),
+			REWRAP_LINES);
+		g_test_minimized_result(total / G_N_ELEMENTS(widths),
+			"rewrap with %u layout thread(s)", threads[t]);
+	}
+
+	gtk_widget_destroy(window);
+}
+
+
+/* Shows text in a new view of the given width, wrapped on layout threads if background is set */
+static ScintillaObject *new_wrapped_view(GtkWidget **window, gint width, gboolean background,
+		const gchar *text)
+{
+	ScintillaObject *sci;
+
+	*window = gtk_offscreen_window_new();
+	sci = SCINTILLA(scintilla_new());
+	gtk_container_add(GTK_CONTAINER(*window), GTK_WIDGET(sci));
+	gtk_window_set_default_size(GTK_WINDOW(*window), width, 400);
+	sci_set_codepage(sci, SC_CP_UTF8);
+	scintilla_set_background_wrap(sci, background);
+	sci_set_lines_wrapped(sci, TRUE);
+	sci_set_text(sci, text);
+	gtk_widget_show_all(*window);
+	while (gtk_widget_get_allocated_width(GTK_WIDGET(sci)) != width)
+		gtk_main_iteration_do(FALSE);
+
+	return sci;
+}
+
+
+static void set_font_size(ScintillaObject *sci, gint size)
+{
+	SSM(sci, SCI_STYLESETSIZE, STYLE_DEFAULT, size);
+	SSM(sci, SCI_STYLECLEARALL, 0, 0);
+}
+
+
+/* Checks the lines wrapped on layout threads get the same heights as when wrapped in idle
+ * time, also when the style changes while blocks are being wrapped */
+static void test_editor_background_wrap(void)
+{
+	static const gchar *const words[] = { "word ", "\tindented ", "\xc3\xa9t\xc3\xa9 ", "a ",
+		"long_identifier_name ", "\xe4\xb8\xad\xe6\x96\x87 " };
+	GtkWidget *window, *window_bg;
+	ScintillaObject *sci, *sci_bg;
+	GString *text = g_string_new(NULL);
+	gint *visible;
+	gint64 deadline;
+	gint line, last;
+
+	for (line = 0; line < BACKGROUND_WRAP_LINES; line++)
+	{
+		gint n_words = g_test_rand_int_range(0, 150);
+
+		while (n_words-- > 0)
+			g_string_append(text, words[g_test_rand_int_range(0, G_N_ELEMENTS(words))]);
+		g_string_append_c(text, '\n');
+	}
+	last = BACKGROUND_WRAP_LINES;
+
+	/* wrapped here, all at once */
+	sci = new_wrapped_view(&window, 600, FALSE, text->str);
+	set_font_size(sci, 12);
+	SSM(sci, SCI_ENSUREVISIBLE, last, 0);
+	visible = g_new(gint, last + 1);
+	for (line = 0; line <= last; line++)
+		visible[line] = SSM(sci, SCI_VISIBLEFROMDOCLINE, line, 0);
+	/* otherwise nothing is left to wrap in the background */
+	g_assert_cmpint(visible[last], >, last);
+
+	/* wrapped on layout threads, changing the font of blocks being wrapped */
+	sci_bg = new_wrapped_view(&window_bg, 600, TRUE, text->str);
+	deadline = g_get_monotonic_time() + BACKGROUND_WRAP_TIMEOUT * G_USEC_PER_SEC;
+	while (SSM(sci_bg, SCI_VISIBLEFROMDOCLINE, last, 0) == last && g_get_monotonic_time() < deadline)
+		gtk_main_iteration_do(FALSE);
+	set_font_size(sci_bg, 12);
+
+	while (SSM(sci_bg, SCI_VISIBLEFROMDOCLINE, last, 0) != visible[last] &&
+		g_get_monotonic_time() < deadline)
+	{
+		gtk_main_iteration_do(FALSE);
+	}
+	for (line = 0; line <= last; line++)
+	{
+		if (SSM(sci_bg, SCI_VISIBLEFROMDOCLINE, line, 0) != visible[line])
+			g_test_message("line %d", line);
+		g_assert_cmpint(SSM(sci_bg, SCI_VISIBLEFROMDOCLINE, line, 0), ==, visible[line]);
+	}
+
+	g_free(visible);
+	g_string_free(text, TRUE);
+	gtk_widget_destroy(window_bg);
+	gtk_widget_destroy(window);
+}
+
+
+/* Counts the matches of text in the whole document like mark all does */
+static gint count_matches(ScintillaObject *sci, gint flags, const gchar *text)
+{
+	struct Sci_TextToFind ttf;
+	gint count = 0;
+
+	ttf.chrg.cpMin = 0;
+	ttf.chrg.cpMax = sci_get_length(sci);
+	ttf.lpstrText = (gchar *) text;
+	while (sci_find_text(sci, flags, &ttf) != -1)
+	{
+		count++;
+		ttf.chrg.cpMin = MAX(ttf.chrgText.cpMax, ttf.chrgText.cpMin + 1);
+	}
+	return count;
+}
+
+
+static void test_editor_find_perf(void)
+{
+	static const struct
+	{
+		gint flags;
+		const gchar *text;
+	}
+	searches[] = {
+		{ 0, "Geany" },
+		{ SCFIND_WHOLEWORD, "Geany" },
+		{ SCFIND_MATCHCASE, "Geany" },
+		{ 0, "\xc3\xa9t\xc3\xa9" },
+		{ SCFIND_WHOLEWORD, "value" }
+	};
+	ScintillaObject *sci;
+	GString *text;
+	guint i;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+
+	text = g_string_sized_new(FIND_TEXT_SIZE + 100);
+	while (text->len < FIND_TEXT_SIZE)
+	{
+		if (g_test_rand_int_range(0, 1000) == 0)
+			g_string_append(text, "geany \xc3\x89T\xc3\x89 GEANY\n");
+		else
+			g_string_append(text, "\tstatic gint function_name(gint parameter) { return value; }\n");
+	}
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+
+	for (i = 0; i < G_N_ELEMENTS(searches); i++)
+	{
+		gdouble elapsed;
+		gint count;
+
+		g_test_timer_start();
+		count = count_matches(sci, searches[i].flags, searches[i].text);
+		elapsed = g_test_timer_elapsed();
+
+		g_test_message("find \"%s\" with flags %d: %d matches in %.3f s",
+			searches[i].text, searches[i].flags, count, elapsed);
+		g_test_minimized_result(elapsed, "find \"%s\" with flags %d",
+			searches[i].text, searches[i].flags);
+	}
+
+	g_object_unref(sci);
+}
+
+
+/* Styles C code with a large list of typenames like document_highlight_tags() sets for
+ * a big project */
+static void test_editor_highlight_perf(void)
+{
+	ScintillaObject *sci;
+	GPtrArray *names;
+	GString *keywords, *text;
+	gdouble elapsed;
+	guint i;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+	sci_set_lexer(sci, SCLEX_CPP);
+
+	names = g_ptr_array_new_with_free_func(g_free);
+	keywords = g_string_new(NULL);
+	for (i = 0; i < HIGHLIGHT_TYPENAMES; i++)
+	{
+		gchar *name = g_strdup_printf("Type%d", g_test_rand_int_range(0, 1000000));
+
+		g_ptr_array_add(names, name);
+		g_string_append(keywords, name);
+		g_string_append_c(keywords, ' ');
+	}
+	sci_set_keywords(sci, 3, keywords->str);
+	g_string_free(keywords, TRUE);
+
+	text = g_string_sized_new(HIGHLIGHT_TEXT_SIZE + 200);
+	while (text->len < HIGHLIGHT_TEXT_SIZE)
+	{
+		g_string_append_printf(text, "static %s *function(%s value, OtherType%d other)\n{\n\treturn value;\n}\n",
+			(gchar *) names->pdata[g_test_rand_int_range(0, names->len)],
+			(gchar *) names->pdata[g_test_rand_int_range(0, names->len)],
+			g_test_rand_int_range(0, 100));
+	}
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+	g_ptr_array_free(names, TRUE);
+
+	g_test_timer_start();
+	sci_colourise(sci, 0, -1);
+	elapsed = g_test_timer_elapsed();
+
+	g_test_message("styled %d bytes with %d typenames in %.3f s",
+		sci_get_length(sci), HIGHLIGHT_TYPENAMES, elapsed);
+	g_test_minimized_result(elapsed, "highlight with %d typenames", HIGHLIGHT_TYPENAMES);
+
+	g_object_unref(sci);
+}
+
+
+/* Appends blocks of a PHP template with tags spanning many lines and long heredocs */
+static GString *php_template(gsize size, gint heredoc_lines)
+{
+	GString *text = g_string_sized_new(size + heredoc_lines * 80);
+	gint block, i;
+
+	for (block = 0; text->len < size; block++)
+	{
+		g_string_append_printf(text, "<div class=\"row\" id=\"r%d\"\n", block);
+		for (i = 0; i < 30; i++)
+			g_string_append_printf(text, "\tdata-x%d=\"%d\" title='t'\n", i, g_test_rand_int_range(0, 1000));
+		g_string_append_printf(text, "\tonclick=\"go(%d)\">\n", block);
+		g_string_append(text, "<p>Text &amp; more <b>bold</b> <input type=\"text\" value=\"v\"></p>\n"
+			"<?php\n$rows = array(1, 2, 3);\nforeach ($rows as $r) {\n\techo \"value $r\";\n}\n"
+			"$page = <<<EOT\n");
+		for (i = 0; i < heredoc_lines; i++)
+			g_string_append_printf(text, "<tr><td class=\"c\">{$rows[%d]}</td><td>$name %d</td></tr>\n",
+				i % 3, g_test_rand_int());
+		g_string_append(text, "EOT;\n$sql = \"SELECT *\n FROM t\n WHERE a = $a\";\n?>\n"
+			"<script type=\"text/javascript\">\nvar x = 1; // c\nfunction f() { return x; }\n</script>\n");
+	}
+	return text;
+}
+
+
+/* Sets up LexHTML as lexer, either SCLEX_HTML or SCLEX_XML */
+static void set_html_lexer(ScintillaObject *sci, gint lexer)
+{
+	sci_set_codepage(sci, SC_CP_UTF8);
+	sci_set_lexer(sci, lexer);
+	SSM(sci, SCI_SETPROPERTY, (uptr_t) "fold", (sptr_t) "1");
+	SSM(sci, SCI_SETPROPERTY, (uptr_t) "fold.html", (sptr_t) "1");
+	sci_set_keywords(sci, 0, "a b div p input td tr script class id type value title onclick");
+	sci_set_keywords(sci, 4, "echo foreach as array");
+}
+
+
+/* Styles up to end from the line where styling stopped, like Scintilla does when drawing */
+static void style_to(ScintillaObject *sci, gint end)
+{
+	gint start = sci_get_position_from_line(sci,
+		sci_get_line_from_position(sci, (gint) SSM(sci, SCI_GETENDSTYLED, 0, 0)));
+
+	if (end > start)
+		sci_colourise(sci, start, end);
+}
+
+
+/* Edits a line of sci, picking the edit from n, and styles the page after it */
+static void edit_html_line(ScintillaObject *sci, gint line, gint n)
+{
+	static const gchar *inserts[] = { "x", "\n", "\"", "<", ">", "\nEOT;\n", "'", "<?php ", "?>", "/>" };
+	gint pos = sci_get_position_from_line(sci, line) + 2;
+
+	if (pos >= sci_get_line_end_position(sci, line))
+		return;
+	if (n % 2)
+		sci_insert_text(sci, pos, inserts[n / 2 % G_N_ELEMENTS(inserts)]);
+	else
+		SSM(sci, SCI_DELETERANGE, pos, 1 + n / 2 % 3);
+	style_to(sci, sci_get_position_from_line(sci,
+		MIN(line + HTML_PAGE_LINES, sci_get_line_count(sci) - 1)));
+}
+
+
+/* Checks resuming LexHTML inside tags and heredocs after edits styles like lexing everything */
+static void check_html_resume(gint lexer)
+{
+	ScintillaObject *sci, *sci_ref;
+	GString *text;
+	gchar *contents;
+	gint i, pos, line, lines;
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_ref = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci_ref);
+	set_html_lexer(sci, lexer);
+	set_html_lexer(sci_ref, lexer);
+
+	text = php_template(200 * 1024, 300);
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+	sci_colourise(sci, 0, -1);
+
+	/* the rest of the document is left unstyled between edits, as until idle time */
+	for (i = 0; i < 1000; i++)
+	{
+		lines = sci_get_line_count(sci);
+		edit_html_line(sci, g_test_rand_int_range(1, lines - 1), i);
+	}
+	style_to(sci, sci_get_length(sci));
+
+	contents = sci_get_contents(sci, -1);
+	sci_set_text(sci_ref, contents);
+	g_free(contents);
+	sci_colourise(sci_ref, 0, -1);
+
+	g_assert_cmpint(sci_get_length(sci), ==, sci_get_length(sci_ref));
+	for (pos = 0; pos < sci_get_length(sci); pos++)
+		g_assert_cmpint(sci_get_style_at(sci, pos), ==, sci_get_style_at(sci_ref, pos));
+	for (line = 0; line < sci_get_line_count(sci); line++)
+	{
+		g_assert_cmpint(SSM(sci, SCI_GETLINESTATE, line, 0), ==, SSM(sci_ref, SCI_GETLINESTATE, line, 0));
+		g_assert_cmpint(SSM(sci, SCI_GETFOLDLEVEL, line, 0), ==, SSM(sci_ref, SCI_GETFOLDLEVEL, line, 0));
+	}
+
+	g_object_unref(sci_ref);
+	g_object_unref(sci);
+}
+
+
+static void test_editor_html_resume(void)
+{
+	/* XML only has the tags spanning lines, the rest is lexed as text */
+	check_html_resume(SCLEX_HTML);
+	check_html_resume(SCLEX_XML);
+}
+
+
+/* Edits a big PHP template inside heredocs and tags and restyles the page shown after each edit */
+static void test_editor_html_edit_perf(void)
+{
+	ScintillaObject *sci;
+	GString *text;
+	gdouble full, page = 0, rest = 0;
+	gint i;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	set_html_lexer(sci, SCLEX_HTML);
+
+	text = php_template(HTML_TEXT_SIZE, HTML_HEREDOC_LINES);
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+
+	g_test_timer_start();
+	sci_colourise(sci, 0, -1);
+	full = g_test_timer_elapsed();
+
+	for (i = 0; i < HTML_EDITS; i++)
+	{
+		g_test_timer_start();
+		edit_html_line(sci, g_test_rand_int_range(1, sci_get_line_count(sci) - 1), i);
+		page += g_test_timer_elapsed();
+
+		/* what idle styling does after each edit */
+		g_test_timer_start();
+		style_to(sci, sci_get_length(sci));
+		rest += g_test_timer_elapsed();
+	}
+
+	g_test_message("styled %d bytes in %.3f s, %.3f ms per edit for the page, %.3f ms for the rest",
+		sci_get_length(sci), full, page * 1000 / HTML_EDITS, rest * 1000 / HTML_EDITS);
+	g_test_minimized_result(page / HTML_EDITS, "restyle the page after an edit of a PHP template");
+
+	g_object_unref(sci);
+}
+
+
+/* The column of pos, or of the line end if pos is -1, walking from the start of its line
+ * like Scintilla without its cache */
+static gint get_column_reference(const gchar *text, gint line_start, gint pos, gint tab_width)
+{
+	const gchar *p = text + line_start;
+	gint column = 0;
+
+	while ((pos < 0 || p < text + pos) && *p && *p != '\r' && *p != '\n')
+	{
+		if (*p == '\t')
+		{
+			column = (column / tab_width + 1) * tab_width;
+			p++;
+		}
+		else
+		{
+			column++;
+			p = g_utf8_next_char(p);
+		}
+	}
+	return column;
+}
+
+
+/* The position of column on the line starting at line_start, like get_column_reference() */
+static gint find_column_reference(const gchar *text, gint line_start, gint column, gint tab_width)
+{
+	const gchar *p = text + line_start;
+	gint current = 0;
+
+	while (current < column && *p && *p != '\r' && *p != '\n')
+	{
+		if (*p == '\t')
+		{
+			current = (current / tab_width + 1) * tab_width;
+			if (current > column)
+				break;
+			p++;
+		}
+		else
+		{
+			current++;
+			p = g_utf8_next_char(p);
+		}
+	}
+	return p - text;
+}
+
+
+/* A random position on line, not inside a character */
+static gint random_line_position(ScintillaObject *sci, gint line)
+{
+	gint start = sci_get_position_from_line(sci, line);
+	gint end = sci_get_line_end_position(sci, line);
+	gint pos = g_test_rand_int_range(start, end + 1);
+
+	return pos < end ? SSM(sci, SCI_POSITIONBEFORE, pos + 1, 0) : end;
+}
+
+
+/* Checks the columns of long lines, which are cached, stay right while they are edited */
+static void test_editor_column_cache(void)
+{
+	static const gchar *const pieces[] = { "a", "word ", "\t", "\xc3\xa9", "\xe4\xb8\xad",
+		"\xf0\x9f\x98\x80", "\t\xc3\xa9\t" };
+	static const gchar *const line_ends[] = { "\r\n", "\n" };
+	ScintillaObject *sci;
+	GString *text = g_string_new(NULL);
+	gint i, line;
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+
+	for (line = 0; line < COLUMN_LINES; line++)
+	{
+		gsize line_start = text->len;
+
+		while (text->len - line_start < COLUMN_LINE_LENGTH)
+			g_string_append(text, pieces[g_test_rand_int_range(0, G_N_ELEMENTS(pieces))]);
+		g_string_append_c(text, '\n');
+	}
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+
+	for (i = 0; i < COLUMN_EDITS; i++)
+	{
+		gint tab_width, line_start, q;
+		const gchar *chars;
+
+		line = g_test_rand_int_range(0, sci_get_line_count(sci));
+		switch (g_test_rand_int_range(0, 10))
+		{
+			case 0:
+				SSM(sci, SCI_SETTABWIDTH, g_test_rand_int_range(1, 9), 0);
+				break;
+			case 1:
+			case 2:
+			case 3:
+			{
+				gint start = random_line_position(sci, line);
+				gint end = MIN(start + g_test_rand_int_range(1, 20), sci_get_length(sci));
+
+				end = end < sci_get_length(sci) ? SSM(sci, SCI_POSITIONBEFORE, end + 1, 0) : end;
+				SSM(sci, SCI_DELETERANGE, start, end - start);
+				break;
+			}
+			case 4:
+				/* rarely, so that most lines stay long enough to be cached */
+				if (g_test_rand_int_range(0, 10) == 0)
+					sci_insert_text(sci, random_line_position(sci, line),
+						line_ends[g_test_rand_int_range(0, G_N_ELEMENTS(line_ends))]);
+				break;
+			default:
+				sci_insert_text(sci, random_line_position(sci, line),
+					pieces[g_test_rand_int_range(0, G_N_ELEMENTS(pieces))]);
+				break;
+		}
+
+		/* the edit may have moved the lines */
+		line = MIN(line, sci_get_line_count(sci) - 1);
+		line_start = sci_get_position_from_line(sci, line);
+		tab_width = SSM(sci, SCI_GETTABWIDTH, 0, 0);
+		chars = (const gchar *) SSM(sci, SCI_GETCHARACTERPOINTER, 0, 0);
+		for (q = 0; q < 5; q++)
+		{
+			gint pos = random_line_position(sci, line);
+			gint column = g_test_rand_int_range(0,
+				get_column_reference(chars, line_start, -1, tab_width) + 10);
+
+			g_assert_cmpint(SSM(sci, SCI_GETCOLUMN, pos, 0), ==,
+				get_column_reference(chars, line_start, pos, tab_width));
+			g_assert_cmpint(SSM(sci, SCI_FINDCOLUMN, line, column), ==,
+				find_column_reference(chars, line_start, column, tab_width));
+		}
+	}
+
+	g_object_unref(sci);
+}
+
+
+/* Checks undo and redo still restore every text once most of the undo text is spilled
+ * to disk because of a tiny undo memory limit */
+static void test_editor_undo_spill(void)
+{
+	static const gchar *const pieces[] = { "a", "word ", "\n", "\xc3\xa9", "0123456789abcdef" };
+	ScintillaObject *sci;
+	GPtrArray *texts = g_ptr_array_new_with_free_func(g_free);
+	gchar *contents;
+	gint i;
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+	sci_set_text(sci, "The original text\nof a few lines\n");
+	SSM(sci, SCI_EMPTYUNDOBUFFER, 0, 0);
+	scintilla_set_undo_memory_limit(sci, UNDO_MEMORY_LIMIT);
+	g_ptr_array_add(texts, sci_get_contents(sci, -1));
+
+	for (i = 0; i < UNDO_EDITS; i++)
+	{
+		gint pos = g_test_rand_int_range(0, sci_get_length(sci) + 1);
+
+		/* keep each edit a separate undo step */
+		sci_start_undo_action(sci);
+		pos = pos < sci_get_length(sci) ? SSM(sci, SCI_POSITIONBEFORE, pos + 1, 0) : pos;
+		if (g_test_rand_int_range(0, 3) == 0 && pos < sci_get_length(sci))
+		{
+			gint end = MIN(pos + g_test_rand_int_range(1, 40), sci_get_length(sci));
+
+			end = end < sci_get_length(sci) ? SSM(sci, SCI_POSITIONBEFORE, end + 1, 0) : end;
+			SSM(sci, SCI_DELETERANGE, pos, end - pos);
+		}
+		else
+			sci_insert_text(sci, pos, pieces[g_test_rand_int_range(0, G_N_ELEMENTS(pieces))]);
+		sci_end_undo_action(sci);
+		g_ptr_array_add(texts, sci_get_contents(sci, -1));
+	}
+
+	for (i = texts->len - 1; i > 0; i--)
+	{
+		SSM(sci, SCI_UNDO, 0, 0);
+		g_assert_cmpint(SSM(sci, SCI_GETSTATUS, 0, 0), ==, SC_STATUS_OK);
+		contents = sci_get_contents(sci, -1);
+		g_assert_cmpstr(contents, ==, texts->pdata[i - 1]);
+		g_free(contents);
+	}
+	g_assert_false(SSM(sci, SCI_CANUNDO, 0, 0));
+
+	for (i = 1; i < (gint) texts->len; i++)
+	{
+		SSM(sci, SCI_REDO, 0, 0);
+		g_assert_cmpint(SSM(sci, SCI_GETSTATUS, 0, 0), ==, SC_STATUS_OK);
+		contents = sci_get_contents(sci, -1);
+		g_assert_cmpstr(contents, ==, texts->pdata[i]);
+		g_free(contents);
+	}
+
+	g_ptr_array_free(texts, TRUE);
+	g_object_unref(sci);
+}
+
+
+static void assert_styles(ScintillaObject *sci, const gchar *expected)
+{
+	gint i;
+
+	for (i = 0; expected[i]; i++)
+		g_assert_cmpint(SSM(sci, SCI_GETSTYLEAT, i, 0), ==, expected[i] - '0');
+	g_assert_cmpint(i, ==, sci_get_length(sci));
+}
+
+
+/* Checks style bytes are only allocated once a style other than 0 is set, and read as 0
+ * until then */
+static void test_editor_style_allocation(void)
+{
+	static const gchar styles[] = { 0, 0, 7, 7, 0 };
+	ScintillaObject *sci;
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_text(sci, "0123456789");
+
+	g_assert_false(scintilla_get_styles_allocated(sci));
+	assert_styles(sci, "0000000000");
+
+	/* 0 is what unallocated styles read as already */
+	SSM(sci, SCI_STARTSTYLING, 0, 0);
+	SSM(sci, SCI_SETSTYLING, 3, 0);
+	g_assert_false(scintilla_get_styles_allocated(sci));
+
+	SSM(sci, SCI_SETSTYLING, 4, 5);
+	g_assert_true(scintilla_get_styles_allocated(sci));
+	assert_styles(sci, "0005555000");
+
+	/* the styles follow edits once allocated */
+	sci_insert_text(sci, 4, "ab");
+	assert_styles(sci, "000500555000");
+	SSM(sci, SCI_DELETERANGE, 0, 2);
+	assert_styles(sci, "0500555000");
+
+	/* clearing all the styles releases them */
+	SSM(sci, SCI_CLEARDOCUMENTSTYLE, 0, 0);
+	g_assert_false(scintilla_get_styles_allocated(sci));
+	assert_styles(sci, "0000000000");
+
+	SSM(sci, SCI_STARTSTYLING, 0, 0);
+	SSM(sci, SCI_SETSTYLINGEX, G_N_ELEMENTS(styles), (sptr_t) styles);
+	g_assert_true(scintilla_get_styles_allocated(sci));
+	assert_styles(sci, "0077000000");
+
+	g_object_unref(sci);
+}
+
+
+/* Checks filling many ranges at once gives the same indicator as filling them one by one */
+static void test_editor_indicator_fill_ranges(void)
+{
+	ScintillaObject *sci, *sci_ref;
+	GArray *ranges;
+	gint i, pos;
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_ref = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci_ref);
+
+	sci_set_text(sci, "0123456789012345678901234567890123456789012345678901234567890123456789");
+	sci_set_text(sci_ref, "0123456789012345678901234567890123456789012345678901234567890123456789");
+	sci_indicator_set(sci, 8);
+	sci_indicator_set(sci_ref, 8);
+	/* some existing runs the new ranges partly overlap */
+	sci_indicator_fill(sci, 3, 6);
+	sci_indicator_fill(sci_ref, 3, 6);
+	sci_indicator_fill(sci, 40, 2);
+	sci_indicator_fill(sci_ref, 40, 2);
+
+	ranges = g_array_new(FALSE, FALSE, sizeof(gintptr));
+	for (pos = 0; pos < 70; )
+	{
+		gintptr range[2];
+
+		/* kept within the text, so no length is negative */
+		range[0] = MIN(pos + g_test_rand_int_range(0, 5), 70);
+		range[1] = MIN(range[0] + g_test_rand_int_range(0, 6), 70);
+		g_array_append_vals(ranges, range, 2);
+		sci_indicator_fill(sci_ref, range[0], range[1] - range[0]);
+		pos = range[1];
+	}
+	scintilla_indicator_fill_ranges(sci, (const gintptr *) ranges->data, ranges->len / 2);
+
+	for (i = 0; i < 70; i++)
+		g_assert_cmpint(SSM(sci, SCI_INDICATORVALUEAT, 8, i), ==, SSM(sci_ref, SCI_INDICATORVALUEAT, 8, i));
+
+	g_array_free(ranges, TRUE);
+	g_object_unref(sci_ref);
+	g_object_unref(sci);
+}
+
+
+static void test_editor_mark_all_perf(void)
+{
+	ScintillaObject *sci;
+	GArray *ranges;
+	GString *text;
+	gdouble elapsed;
+	gint i;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+
+	text = g_string_sized_new(MARK_ALL_MATCHES * 20);
+	ranges = g_array_new(FALSE, FALSE, sizeof(gintptr));
+	for (i = 0; i < MARK_ALL_MATCHES; i++)
+	{
+		gintptr range[2];
+
+		range[0] = text->len + 4;
+		range[1] = range[0] + 5;
+		g_array_append_vals(ranges, range, 2);
+		g_string_append(text, "int match;\n");
+	}
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+
+	sci_indicator_set(sci, 8);
+	g_test_timer_start();
+	scintilla_indicator_fill_ranges(sci, (const gintptr *) ranges->data, ranges->len / 2);
+	elapsed = g_test_timer_elapsed();
+
+	g_test_message("marked %d matches in %.3f s", MARK_ALL_MATCHES, elapsed);
+	g_test_minimized_result(elapsed, "mark %d matches", MARK_ALL_MATCHES);
+
+	g_array_free(ranges, TRUE);
+	g_object_unref(sci);
+}
+
+
+/* Folds and unfolds all of a document with many nested fold points like editor_fold_all() */
+static void test_editor_fold_all_perf(void)
+{
+	ScintillaObject *sci;
+	GString *text;
+	gdouble elapsed;
+	gint i;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_lexer(sci, SCLEX_CPP);
+	SSM(sci, SCI_SETPROPERTY, (uptr_t) "fold", (sptr_t) "1");
+
+	/* 10 lines per block, with 2 nested fold points */
+	text = g_string_sized_new(FOLD_BLOCKS * 100);
+	for (i = 0; i < FOLD_BLOCKS; i++)
+		g_string_append(text, "void f()\n{\n\tif (a)\n\t{\n\t\tb();\n\t}\n\tc();\n}\n\n\n");
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+	sci_colourise(sci, 0, -1);
+
+	g_test_timer_start();
+	SSM(sci, SCI_FOLDALL, SC_FOLDACTION_CONTRACT | SC_FOLDACTION_CONTRACT_EVERY_LEVEL, 0);
+	elapsed = g_test_timer_elapsed();
+	/* the nested fold point is contracted and hidden */
+	g_assert_true(SSM(sci, SCI_GETLINEVISIBLE, 1, 0));
+	g_assert_false(SSM(sci, SCI_GETLINEVISIBLE, 3, 0));
+	g_assert_false(SSM(sci, SCI_GETFOLDEXPANDED, 3, 0));
+	g_test_message("folded %d lines in %.3f s", sci_get_line_count(sci), elapsed);
+	g_test_minimized_result(elapsed, "fold all of %d lines", sci_get_line_count(sci));
+
+	g_test_timer_start();
+	SSM(sci, SCI_FOLDALL, SC_FOLDACTION_EXPAND, 0);
+	elapsed = g_test_timer_elapsed();
+	g_assert_true(SSM(sci, SCI_GETALLLINESVISIBLE, 0, 0));
+	g_test_message("unfolded %d lines in %.3f s", sci_get_line_count(sci), elapsed);
+	g_test_minimized_result(elapsed, "unfold all of %d lines", sci_get_line_count(sci));
+
+	g_object_unref(sci);
+}
+
+
+static void on_accessible_text_changed(AtkText *text, gint position, gint length, gint *total)
+{
+	total[0]++;
+	total[1] += length;
+}
+
+
+static void flush_events(void)
+{
+	while (gtk_events_pending())
+		gtk_main_iteration();
+}
+
+
+/* Checks the changes of a user action are reported to assistive technologies at once */
+static void test_editor_accessible_changes(void)
+{
+	ScintillaObject *sci;
+	AtkObject *accessible;
+	gint inserts[2] = { 0, 0 }, deletes[2] = { 0, 0 };
+	gint i;
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+	accessible = gtk_widget_get_accessible(GTK_WIDGET(sci));
+	g_signal_connect(accessible, "text-changed::insert", G_CALLBACK(on_accessible_text_changed), inserts);
+	g_signal_connect(accessible, "text-changed::delete", G_CALLBACK(on_accessible_text_changed), deletes);
+
+	sci_set_text(sci, "h\xc3\xa9llo w\xc3\xb6rld\nsecond line\n");
+	flush_events();
+	g_assert_cmpint(atk_text_get_character_count(ATK_TEXT(accessible)), ==, 24);
+	inserts[0] = inserts[1] = deletes[0] = deletes[1] = 0;
+
+	/* a single change is reported right away */
+	sci_insert_text(sci, 0, "\xc3\xa0");
+	g_assert_cmpint(inserts[0], ==, 1);
+	g_assert_cmpint(inserts[1], ==, 1);
+
+	/* changes inside an undo action are reported once as one replacement */
+	inserts[0] = inserts[1] = 0;
+	sci_start_undo_action(sci);
+	for (i = 0; i < 10; i++)
+		sci_insert_text(sci, i % 2 ? 0 : sci_get_length(sci), "\xe2\x82\xac");
+	/* the second of the euro signs at the start */
+	SSM(sci, SCI_DELETERANGE, 3, 3);
+	sci_end_undo_action(sci);
+	g_assert_cmpint(inserts[0], ==, 0);
+	flush_events();
+	g_assert_cmpint(inserts[0], ==, 1);
+	g_assert_cmpint(deletes[0], ==, 1);
+	g_assert_cmpint(inserts[1] - deletes[1], ==, 10 - 1);
+	g_assert_cmpint(atk_text_get_character_count(ATK_TEXT(accessible)), ==, 25 + 10 - 1);
+
+	/* undoing it too */
+	inserts[0] = inserts[1] = deletes[0] = deletes[1] = 0;
+	SSM(sci, SCI_UNDO, 0, 0);
+	g_assert_cmpint(inserts[0], ==, 1);
+	g_assert_cmpint(deletes[0], ==, 1);
+	g_assert_cmpint(inserts[1] - deletes[1], ==, 1 - 10);
+
+	/* the count follows line ends joined and split by separate edits */
+	sci_set_text(sci, "c");
+	sci_insert_text(sci, 1, "\r");
+	sci_insert_text(sci, 2, "\n");
+	g_assert_cmpint(atk_text_get_character_count(ATK_TEXT(accessible)), ==, 3);
+	sci_insert_text(sci, 2, "\xc3\xa9");
+	g_assert_cmpint(atk_text_get_character_count(ATK_TEXT(accessible)), ==, 4);
+	SSM(sci, SCI_DELETERANGE, 2, 2);
+	g_assert_cmpint(atk_text_get_character_count(ATK_TEXT(accessible)), ==, 3);
+
+	g_object_unref(sci);
+}
+
+
+static void test_editor_accessible_perf(void)
+{
+	ScintillaObject *sci;
+	AtkText *text;
+	GString *str;
+	gdouble elapsed;
+	gint i, count;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+	text = ATK_TEXT(gtk_widget_get_accessible(GTK_WIDGET(sci)));
+
+	str = g_string_sized_new(ACCESSIBLE_TEXT_SIZE + 100);
+	while (str->len < ACCESSIBLE_TEXT_SIZE)
+		g_string_append(str, "\tgchar *r\xc3\xa9sum\xc3\xa9 = g_strdup(\"\xe2\x82\xac\");\n");
+	sci_set_text(sci, str->str);
+	g_string_free(str, TRUE);
+	flush_events();
+
+	g_test_timer_start();
+	for (i = 0; i < ACCESSIBLE_QUERIES; i++)
+	{
+		gint offset, start, end;
+		gchar *line;
+
+		count = atk_text_get_character_count(text);
+		offset = g_test_rand_int_range(0, count);
+		line = atk_text_get_string_at_offset(text, offset, ATK_TEXT_GRANULARITY_LINE, &start, &end);
+		g_free(line);
+		atk_text_set_caret_offset(text, offset);
+		g_assert_cmpint(atk_text_get_caret_offset(text), ==, offset);
+	}
+	elapsed = g_test_timer_elapsed();
+	g_test_message("%d accessible queries on %d characters in %.3f s", ACCESSIBLE_QUERIES, count, elapsed);
+	g_test_minimized_result(elapsed, "%d accessible queries", ACCESSIBLE_QUERIES);
+
+	/* like replacing all matches */
+	g_test_timer_start();
+	sci_start_undo_action(sci);
+	for (i = 0; i < ACCESSIBLE_QUERIES * 10; i++)
+	{
+		gint pos = g_test_rand_int_range(0, sci_get_length(sci));
+
+		pos = SSM(sci, SCI_POSITIONBEFORE, pos + 1, 0);
+		sci_insert_text(sci, pos, "\xc3\xa9");
+	}
+	sci_end_undo_action(sci);
+	flush_events();
+	elapsed = g_test_timer_elapsed();
+	g_test_message("%d edits in one action in %.3f s", ACCESSIBLE_QUERIES * 10, elapsed);
+	g_test_minimized_result(elapsed, "%d accessible edits", ACCESSIBLE_QUERIES * 10);
+
+	g_object_unref(sci);
+}
+
+
+static void on_minimap_draw(GtkWidget *widget, cairo_t *cr, gint *draws)
+{
+	(*draws)++;
+}
+
+
+/* Edits the document and waits until the minimap has been drawn again.
+ * Returns the elapsed time in seconds. */
+static gdouble edit_and_draw_minimap(ScintillaObject *sci, const gint *draws, const gchar *text)
+{
+	gint old_draws = *draws;
+	gint line = g_test_rand_int_range(0, sci_get_line_count(sci));
+
+	g_test_timer_start();
+	sci_insert_text(sci, sci_get_position_from_line(sci, line), text);
+	while (*draws == old_draws)
+		gtk_main_iteration_do(TRUE);
+	return g_test_timer_elapsed();
+}
+
+
+/* Draws the minimap of documents of different sizes, which should take about as long */
+static void test_editor_minimap_perf(void)
+{
+	static const gint line_counts[] = { 1000, MINIMAP_LINES };
+	guint i;
+
+	if (! g_test_perf())
+	{
+		g_test_skip("Only run in performance mode (-m perf)");
+		return;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS(line_counts); i++)
+	{
+		GtkWidget *window, *hbox, *minimap;
+		ScintillaObject *sci;
+		GString *text;
+		gdouble first, typing = 0, new_lines = 0;
+		gint draws = 0;
+		gint j;
+
+		window = gtk_offscreen_window_new();
+		hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+		sci = SCINTILLA(scintilla_new());
+		minimap = geany_minimap_new(sci);
+		geany_minimap_set_width(GEANY_MINIMAP(minimap), 100);
+		g_signal_connect_after(minimap, "draw", G_CALLBACK(on_minimap_draw), &draws);
+		gtk_box_pack_start(GTK_BOX(hbox), GTK_WIDGET(sci), TRUE, TRUE, 0);
+		gtk_box_pack_start(GTK_BOX(hbox), minimap, FALSE, FALSE, 0);
+		gtk_container_add(GTK_CONTAINER(window), hbox);
+		gtk_window_set_default_size(GTK_WINDOW(window), 800, 600);
+		gtk_widget_show_all(window);
+
+		sci_set_codepage(sci, SC_CP_UTF8);
+		sci_set_lexer(sci, SCLEX_CPP);
+		text = g_string_sized_new(line_counts[i] * 40);
+		for (j = 0; j < line_counts[i]; j++)
+			g_string_append_printf(text, "%*sint value%d = %d; /* comment */\n", j % 4 * 4, "", j, j);
+		sci_set_text(sci, text->str);
+		g_string_free(text, TRUE);
+
+		g_test_timer_start();
+		while (draws == 0)
+			gtk_main_iteration_do(TRUE);
+		first = g_test_timer_elapsed();
+
+		for (j = 0; j < MINIMAP_EDITS; j++)
+		{
+			typing += edit_and_draw_minimap(sci, &draws, "x");
+			new_lines += edit_and_draw_minimap(sci, &draws, "\n");
+		}
+
+		g_test_message("%d lines: first frame in %.3f s, %.3f ms per frame when typing, "
+			"%.3f ms per frame when adding lines", line_counts[i], first,
+			typing * 1000 / MINIMAP_EDITS, new_lines * 1000 / MINIMAP_EDITS);
+		g_test_minimized_result(new_lines / MINIMAP_EDITS,
+			"minimap frame after adding a line to %d lines", line_counts[i]);
+
+		gtk_widget_destroy(window);
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	/* this test needs a display */
+	if (! gtk_init_check(&argc, &argv))
+		return 77;	/* skipped */
+
+	main_init_headless();
+
+	EDITOR_TEST_ADD("rewrap_perf", test_editor_rewrap_perf);
+	EDITOR_TEST_ADD("background_wrap", test_editor_background_wrap);
+	EDITOR_TEST_ADD("find_perf", test_editor_find_perf);
+	EDITOR_TEST_ADD("highlight_perf", test_editor_highlight_perf);
+	EDITOR_TEST_ADD("html_resume", test_editor_html_resume);
+	EDITOR_TEST_ADD("html_edit_perf", test_editor_html_edit_perf);
+	EDITOR_TEST_ADD("style_allocation", test_editor_style_allocation);
+	EDITOR_TEST_ADD("indicator_fill_ranges", test_editor_indicator_fill_ranges);
+	EDITOR_TEST_ADD("column_cache", test_editor_column_cache);
+	EDITOR_TEST_ADD("undo_spill", test_editor_undo_spill);
+	EDITOR_TEST_ADD("mark_all_perf", test_editor_mark_all_perf);
+	EDITOR_TEST_ADD("fold_all_perf", test_editor_fold_all_perf);
+	EDITOR_TEST_ADD("accessible_changes", test_editor_accessible_changes);
+	EDITOR_TEST_ADD("accessible_perf", test_editor_accessible_perf);
+	EDITOR_TEST_ADD("minimap_perf", test_editor_minimap_perf);
+
+	return g_test_run();
+}
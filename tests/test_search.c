@@ -0,0 +1,223 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "main.h"
+#include "sciwrappers.h"
+#include "search.h"
+
+#define SEARCH_TEST_ADD(path, func) g_test_add_func("/search/" path, func);
+
+#define PREFILTER_LINES 20000
+#define PREFILTER_LINE_LENGTH 40
+
+
+static gboolean have_display = FALSE;
+
+
+static void test_search_regex_required_literal(void)
+{
+	static const struct
+	{
+		const gchar *pattern;
+		GRegexCompileFlags flags;
+		const gchar *literal;	/* NULL if there is none */
+	}
+	tests[] = {
+		{ "foobar", 0, "foobar" },
+		{ "^start$", 0, "start" },
+		/* classes */
+		{ "foo[a-z]+barbaz", 0, "barbaz" },
+		{ "[]abc]xyz", 0, "xyz" },
+		{ "[^]a]xyz", 0, "xyz" },
+		{ "[[:alpha:]]+hello", 0, "hello" },
+		{ "x[\\]ab]yz", 0, "yz" },
+		{ "x[abc", 0, NULL },
+		/* escapes */
+		{ "ab\\.cd", 0, "ab.cd" },
+		{ "ab\\(cd", 0, "ab(cd" },
+		{ "abc\\dxy", 0, "abc" },
+		{ "\\bword\\b", 0, "word" },
+		{ "ab\\tcd", 0, "ab" },
+		{ "\\x41bc", 0, NULL },
+		{ "\\p{L}abc", 0, NULL },
+		{ "(a)\\1bc", 0, NULL },
+		{ "\\Qa.b\\E", 0, NULL },
+		{ "abc\\", 0, NULL },
+		/* quantifiers make the previous character optional */
+		{ "abcd?ef", 0, "abc" },
+		{ "abcd*ef", 0, "abc" },
+		{ "abcd{0,}ef", 0, "abc" },
+		{ "abcd{0,1}ef", 0, "abc" },
+		{ "abc*?d", 0, "ab" },
+		{ "ab+cd", 0, "ab" },
+		{ "ab\\.?cd", 0, "ab" },
+		{ "(ab)?cdef", 0, "cdef" },
+		{ "[ab]*cdef", 0, "cdef" },
+		{ "a{b", 0, NULL },
+		/* alternation and groups */
+		{ "a|bcd", 0, NULL },
+		{ "abc|", 0, NULL },
+		{ "(foo|bar)bazz", 0, "bazz" },
+		{ "x(a)y", 0, "x" },
+		{ "(?:x)abc", 0, "abc" },
+		{ "(?=ab)abc", 0, "abc" },
+		{ "(a[)]b)cde", 0, "cde" },
+		{ "ab)c", 0, NULL },
+		/* inline options change the meaning of the rest */
+		{ "(?i)abc", 0, NULL },
+		{ "ab(?x)c d", 0, NULL },
+		{ "abc", G_REGEX_EXTENDED, NULL },
+		/* non-ASCII characters are left out */
+		{ "\xc3\xa9" "abcd", 0, "abcd" },
+		{ "ab\xc3\xa9" "c", 0, "ab" },
+		/* caseless: 'k' and 's' also match U+212A and U+017F */
+		{ "ABCDEF", G_REGEX_CASELESS, "ABCDEF" },
+		{ "maskedvalue", G_REGEX_CASELESS, "edvalue" },
+		{ "STACK", G_REGEX_CASELESS, "TAC" },
+		{ "maskedvalue", 0, "maskedvalue" },
+	};
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(tests); i++)
+	{
+		GError *error = NULL;
+		GRegex *regex = g_regex_new(tests[i].pattern, tests[i].flags, 0, &error);
+		gchar *literal;
+
+		/* a few of the patterns above are invalid on purpose */
+		if (! regex)
+		{
+			g_assert_null(tests[i].literal);
+			g_error_free(error);
+			continue;
+		}
+		literal = search_get_regex_required_literal(regex);
+		if (g_strcmp0(literal, tests[i].literal) != 0)
+			g_test_message("pattern \"%s\"", tests[i].pattern);
+		g_assert_cmpstr(literal, ==, tests[i].literal);
+		g_free(literal);
+		g_regex_unref(regex);
+	}
+}
+
+
+/* Like find_regex() without the literal prefilter: matches the regex against each line */
+static gint find_regex_reference(ScintillaObject *sci, GRegex *regex, gint pos, gint *end)
+{
+	const gchar *text = (const gchar *) SSM(sci, SCI_GETCHARACTERPOINTER, 0, 0);
+	gint line_count = sci_get_line_count(sci);
+	gint line;
+
+	for (line = sci_get_line_from_position(sci, pos); line < line_count; line++)
+	{
+		gint start = sci_get_position_from_line(sci, line);
+		gint line_end = sci_get_line_end_position(sci, line);
+		GMatchInfo *minfo;
+		gint match_start = -1;
+
+		if (g_regex_match_full(regex, text + start, line_end - start, MAX(pos, start) - start,
+				0, &minfo, NULL))
+		{
+			g_match_info_fetch_pos(minfo, 0, &match_start, end);
+			match_start += start;
+			*end += start;
+		}
+		g_match_info_free(minfo);
+		if (match_start >= 0)
+			return match_start;
+	}
+	return -1;
+}
+
+
+/* Compares every match found with the prefilter against the plain line by line matching,
+ * on random text made of the characters the prefilter has to care about */
+static void test_search_regex_prefilter(void)
+{
+	static const gchar *const chars[] = {
+		"a", "b", "c", "k", "s", "A", "K", "S", ".", " ", "(",
+		"\xc3\xa9", "\xc3\x89",	/* é É */
+		"\xe2\x84\xaa",			/* KELVIN SIGN, matches k caselessly */
+		"\xc5\xbf"				/* LATIN SMALL LETTER LONG S, matches s caselessly */
+	};
+	static const gchar *const patterns[] = {
+		"abc", "a.c", "ab+c", "[ab]kc", "ka?b", "(a|b)ck", "s\\.k", "BA{0,}c", "ks",
+		"\\bbak", "sk*a", "\xc3\xa9" "ab", "a\\(b", "^ab", "ca$"
+	};
+	ScintillaObject *sci;
+	GString *text;
+	guint i, j;
+
+	if (! have_display)
+	{
+		g_test_skip("Needs a display");
+		return;
+	}
+
+	sci = SCINTILLA(scintilla_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+
+	text = g_string_sized_new(PREFILTER_LINES * (PREFILTER_LINE_LENGTH + 1) * 2);
+	for (i = 0; i < PREFILTER_LINES; i++)
+	{
+		for (j = 0; j < PREFILTER_LINE_LENGTH; j++)
+			g_string_append(text, chars[g_test_rand_int_range(0, G_N_ELEMENTS(chars))]);
+		g_string_append_c(text, '\n');
+	}
+	sci_set_text(sci, text->str);
+	g_string_free(text, TRUE);
+
+	for (i = 0; i < G_N_ELEMENTS(patterns) * 2; i++)
+	{
+		const gchar *pattern = patterns[i / 2];
+		GeanyFindFlags flags = GEANY_FIND_REGEXP | (i % 2 ? GEANY_FIND_MATCHCASE : 0);
+		GRegex *regex = g_regex_new(pattern, i % 2 ? 0 : G_REGEX_CASELESS, 0, NULL);
+		gint pos = 0;
+		gint count = 0;
+
+		g_assert_nonnull(regex);
+		for (;;)
+		{
+			GeanyMatchInfo *match = NULL;
+			gint expected_end = -1;
+			gint expected = find_regex_reference(sci, regex, pos, &expected_end);
+			gint found;
+
+			sci_set_current_position(sci, pos, FALSE);
+			found = search_find_next(sci, pattern, flags, &match);
+			if (found != expected)
+				g_test_message("pattern \"%s\", flags %d, from %d", pattern, flags, pos);
+			g_assert_cmpint(found, ==, expected);
+			if (found < 0)
+				break;
+			g_assert_cmpint(match->end, ==, expected_end);
+			geany_match_info_free(match);
+
+			count++;
+			/* none of the patterns matches the empty string */
+			pos = expected_end;
+		}
+		g_test_message("\"%s\" with flags %d: %d matches", pattern, flags, count);
+		g_assert_cmpint(count, >, 0);
+		g_regex_unref(regex);
+	}
+
+	g_object_unref(sci);
+}
+
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	have_display = gtk_init_check(&argc, &argv);
+
+	main_init_headless();
+
+	SEARCH_TEST_ADD("regex_required_literal", test_search_regex_required_literal);
+	SEARCH_TEST_ADD("regex_prefilter", test_search_regex_prefilter);
+
+	return g_test_run();
+}
@@ -0,0 +1,97 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "main.h"
+#include "tm_ctags.h"
+#include "tm_source_file.h"
+#include "tm_workspace.h"
+
+#include <glib/gstdio.h>
+
+#define TAGMANAGER_TEST_ADD(path, func) g_test_add_func("/tagmanager/" path, func);
+
+/* minified code comes as a single line, which the budget must still be able to cut */
+#define MINIFIED_SIZE (4 * 1024 * 1024)
+#define MINIFIED_CHUNK "function f%u(a,b){return a+b;}var v%u=[1,2,3];"
+
+
+static gchar *write_minified_js(GString **text)
+{
+	GError *error = NULL;
+	gchar *file_name;
+	guint i;
+	gint fd;
+
+	*text = g_string_sized_new(MINIFIED_SIZE + 64);
+	for (i = 0; (*text)->len < MINIFIED_SIZE; i++)
+		g_string_append_printf(*text, MINIFIED_CHUNK, i, i);
+
+	fd = g_file_open_tmp("geany-test-XXXXXX.js", &file_name, &error);
+	g_assert_no_error(error);
+	g_close(fd, NULL);
+	g_file_set_contents(file_name, (*text)->str, (*text)->len, &error);
+	g_assert_no_error(error);
+
+	return file_name;
+}
+
+
+static void test_tagmanager_budget_single_line(void)
+{
+	TMSourceFile *sf;
+	GString *text;
+	gchar *file_name = write_minified_js(&text);
+	guint full_len;
+
+	sf = tm_source_file_new(file_name, "JavaScript");
+	g_assert_nonnull(sf);
+
+	/* without a budget, the whole line is parsed */
+	tm_ctags_set_parse_budget(0, 0);
+	g_assert_true(tm_source_file_parse(sf, (guchar *) text->str, text->len, TRUE));
+	g_assert_false(sf->partial);
+	full_len = sf->tags_array->len;
+	g_assert_cmpuint(full_len, >, 0);
+
+	/* a byte budget stops inside the line and keeps the tags found so far */
+	tm_ctags_set_parse_budget(64 * 1024, 0);
+	g_assert_true(tm_source_file_parse(sf, (guchar *) text->str, text->len, TRUE));
+	g_assert_true(sf->partial);
+	g_assert_cmpuint(sf->tags_array->len, >, 0);
+	g_assert_cmpuint(sf->tags_array->len, <, full_len / 10);
+
+	/* so does a time budget, checked while the line is consumed */
+	tm_ctags_set_parse_budget(0, 1);
+	g_assert_true(tm_source_file_parse(sf, (guchar *) text->str, text->len, TRUE));
+	g_assert_true(sf->partial);
+	g_assert_cmpuint(sf->tags_array->len, <, full_len);
+
+	/* and when reading from the file rather than a buffer */
+	g_assert_true(tm_source_file_parse(sf, NULL, 0, FALSE));
+	g_assert_true(sf->partial);
+
+	tm_ctags_set_parse_budget(0, 0);
+	g_assert_true(tm_source_file_parse(sf, (guchar *) text->str, text->len, TRUE));
+	g_assert_false(sf->partial);
+	g_assert_cmpuint(sf->tags_array->len, ==, full_len);
+
+	tm_source_file_free(sf);
+	g_unlink(file_name);
+	g_free(file_name);
+	g_string_free(text, TRUE);
+}
+
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	main_init_headless();
+	/* sets up the ctags parsers */
+	tm_get_workspace();
+
+	TAGMANAGER_TEST_ADD("budget_single_line", test_tagmanager_budget_single_line);
+
+	return g_test_run();
+}
@@ -1,5 +1,6 @@
 
 #include "main.h"
+#include "sciwrappers.h"
 #include "utils.h"
 
 #include "gtkcompat.h"
@@ -510,6 +511,55 @@ static void test_utils_replace_document_placeholders(void)
 #undef CHECK_DOC_PL
 }
 
+static void test_utils_scan_text(void)
+{
+	GeanyTextScan scan;
+	gchar *big;
+	gsize i;
+
+#define CHECK_SCAN(str, valid, nul, n_lines, eol) \
+	G_STMT_START { \
+		utils_scan_text(str, sizeof(str) - 1, &scan); \
+		g_assert_cmpuint(scan.valid_len, ==, valid); \
+		g_assert_cmpuint(scan.nul_pos, ==, nul); \
+		g_assert_cmpuint(scan.lines, ==, n_lines); \
+		g_assert_cmpint(scan.eol_mode, ==, eol); \
+		g_assert_cmpint(utils_get_line_endings(str, sizeof(str) - 1), ==, eol); \
+	} G_STMT_END
+
+	CHECK_SCAN("", 0, 0, 1, SC_EOL_LF);
+	CHECK_SCAN("one line", 8, 8, 1, SC_EOL_LF);
+	CHECK_SCAN("a long enough line\nfor the word at a time\npath\n", 47, 47, 4, SC_EOL_LF);
+	CHECK_SCAN("dos\r\nline\r\nendings\nmostly\r\n", 27, 27, 5, SC_EOL_CRLF);
+	CHECK_SCAN("old\rmac\r\rendings\r\n", 18, 18, 5, SC_EOL_CR);
+	CHECK_SCAN("split crlf here\r\n", 17, 17, 2, SC_EOL_CRLF);
+	CHECK_SCAN("nul\0after\0", 10, 3, 1, SC_EOL_LF);
+	/* "é", "€", U+10FFFF and a noncharacter are fine */
+	CHECK_SCAN("\xc3\xa9\xe2\x82\xac\n\xf4\x8f\xbf\xbf\xef\xbf\xbe", 13, 13, 2, SC_EOL_LF);
+	/* overlong, surrogate, too big, stray trail byte and truncated sequence */
+	CHECK_SCAN("ab\xc0\xaf\n", 2, 5, 2, SC_EOL_LF);
+	CHECK_SCAN("ab\xed\xa0\x80", 2, 5, 1, SC_EOL_LF);
+	CHECK_SCAN("ab\xf4\x90\x80\x80", 2, 6, 1, SC_EOL_LF);
+	CHECK_SCAN("\xc3\xa9\xa9\n\0", 2, 4, 2, SC_EOL_LF);
+	CHECK_SCAN("abcdefgh\xe2\x82", 8, 10, 1, SC_EOL_LF);
+
+#undef CHECK_SCAN
+
+	/* agree with g_utf8_validate() on every invalid byte in a long valid text */
+	big = g_strnfill(1000, 'x');
+	for (i = 0; i < 1000; i += 7)
+	{
+		const gchar *end;
+
+		big[i] = '\xff';
+		utils_scan_text(big, 1000, &scan);
+		g_assert_false(g_utf8_validate(big, 1000, &end));
+		g_assert_cmpuint(scan.valid_len, ==, end - big);
+		big[i] = 'x';
+	}
+	g_free(big);
+}
+
 int main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
@@ -523,6 +573,7 @@ int main(int argc, char **argv)
 	UTIL_TEST_ADD("get_initals", test_utils_get_initials);
 	UTIL_TEST_ADD("replace_placeholders", test_utils_replace_placeholders);
 	UTIL_TEST_ADD("replace_document_placeholders", test_utils_replace_document_placeholders);
+	UTIL_TEST_ADD("scan_text", test_utils_scan_text);
 
 	return g_test_run();
 }